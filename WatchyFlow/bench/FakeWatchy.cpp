@@ -0,0 +1,117 @@
+#include "FakeWatchy.h"
+
+// Watchy.cpp talks to the RTC, accelerometer, radio and panel, so it isn't
+// built on the host. These are the parts of Watchy the Apps call, backed by
+// the fields of FakeSensors instead of hardware.
+
+FakeSensors fakeSensors = {
+    .battVoltage                = 3.9,
+    .temperature                = 21,
+    .stepCounter                = 4312,
+    .totalStepCounter           = 123456,
+    .lastSuccessfulNetworkFetch = 0,
+    .nextNetworkFetch           = 0,
+    .nextNetworkFetchReasons    = 0,
+    .skippedRefreshes           = 0,
+    .wifiMillis                 = {0, 0},
+};
+
+namespace {
+time_t timezoneOffset_;
+HTTPPool http_;
+} // namespace
+
+WatchyDisplay::WatchyDisplay()
+    : GxEPD2_EPD(-1, -1, -1, -1, HIGH, 10000000, WIDTH, HEIGHT, panel,
+                 hasColor, hasPartialUpdate, hasFastPartialUpdate) {}
+
+tmElements_t fakeLocalTime(time_t unix, time_t timezoneOffset) {
+  tmElements_t local;
+  timezoneOffset_ = timezoneOffset;
+  breakTime(unix + timezoneOffset, local);
+  return local;
+}
+
+void Watchy::setTimezoneOffset(time_t seconds) { timezoneOffset_ = seconds; }
+
+time_t Watchy::timezoneOffset() { return timezoneOffset_; }
+
+time_t Watchy::toUnixTime(const tmElements_t &local) {
+  return makeTime(local) - timezoneOffset_;
+}
+
+tmElements_t Watchy::toLocalTime(time_t unix) {
+  tmElements_t local;
+  unix += timezoneOffset_;
+  breakTime(unix, local);
+  return local;
+}
+
+void Watchy::queueVibrate(uint8_t intervalMs, uint8_t length) {
+  if (int(vibrateIntervalMs_) * int(vibrateLength_) <
+      int(intervalMs) * int(length)) {
+    vibrateIntervalMs_ = intervalMs;
+    vibrateLength_     = length;
+  }
+}
+
+int Watchy::battPercent() {
+  int percent = (battVoltage() - settings_.emptyVoltage) * 100 /
+                (settings_.fullVoltage - settings_.emptyVoltage);
+  if (percent > 100) {
+    percent = 100;
+  }
+  if (percent < 0) {
+    percent = 0;
+  }
+  return percent;
+}
+
+float Watchy::battVoltage() { return fakeSensors.battVoltage; }
+
+void Watchy::addTrigger(time_t when) {}
+
+void Watchy::triggerNetworkFetch() {}
+
+HTTPPool &Watchy::http() { return http_; }
+
+time_t Watchy::nextNetworkFetch() { return fakeSensors.nextNetworkFetch; }
+
+uint8_t Watchy::nextNetworkFetchReasons() {
+  return fakeSensors.nextNetworkFetchReasons;
+}
+
+uint16_t Watchy::wifiMillis(WiFiStage stage) {
+  return fakeSensors.wifiMillis[stage];
+}
+
+time_t Watchy::lastSuccessfulNetworkFetch() {
+  return fakeSensors.lastSuccessfulNetworkFetch;
+}
+
+uint32_t Watchy::stepCounter() { return fakeSensors.stepCounter; }
+
+void Watchy::resetStepCounter() {}
+
+uint32_t Watchy::totalStepCounter() { return fakeSensors.totalStepCounter; }
+
+uint8_t Watchy::temperature() { return fakeSensors.temperature; }
+
+uint32_t Watchy::skippedRefreshes() { return fakeSensors.skippedRefreshes; }
+
+bool Watchy::accel(AccelData &acc) {
+  acc.x = 0;
+  acc.y = 0;
+  acc.z = -1000;
+  return true;
+}
+
+WatchDirection Watchy::direction() { return DIRECTION_DISPLAY_UP; }
+
+uint16_t Watchy::foregroundColor() const {
+  return settings_.darkMode ? GxEPD_WHITE : GxEPD_BLACK;
+}
+
+uint16_t Watchy::backgroundColor() const {
+  return settings_.darkMode ? GxEPD_BLACK : GxEPD_WHITE;
+}
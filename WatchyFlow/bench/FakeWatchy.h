@@ -0,0 +1,30 @@
+#pragma once
+
+#include "../src/Watchy/Watchy.h"
+
+// FakeSensors holds what the fake Watchy reports for its hardware readings.
+typedef struct FakeSensors {
+  float battVoltage;
+  uint8_t temperature;
+  uint32_t stepCounter;
+  uint32_t totalStepCounter;
+  time_t lastSuccessfulNetworkFetch;
+  time_t nextNetworkFetch;
+  uint8_t nextNetworkFetchReasons;
+  uint32_t skippedRefreshes;
+  uint16_t wifiMillis[WIFI_STAGES];
+} FakeSensors;
+
+extern FakeSensors fakeSensors;
+
+// fakeLocalTime sets the timezone offset for all Watchy instances and returns
+// unix converted to local time.
+tmElements_t fakeLocalTime(time_t unix, time_t timezoneOffset);
+
+// BenchWatchy is a Watchy the benchmark can construct directly, without going
+// through Watchy::wakeup(). It wakes up at unix in the given timezone.
+class BenchWatchy : public Watchy {
+public:
+  BenchWatchy(time_t unix, time_t timezoneOffset, WatchySettings settings)
+      : Watchy(fakeLocalTime(unix, timezoneOffset), WAKEUP_CLOCK, settings) {}
+};
@@ -0,0 +1,428 @@
+// bench draws the firmware's Apps into a host-side framebuffer thousands of
+// times and reports what each frame cost. See the Benchmarking section of the
+// README.
+//
+//     build/bench [-n frames] [-o outdir]
+//
+// -o writes the last frame of every scenario to outdir as a PBM image.
+
+#include <HTTPClient.h>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "FakeWatchy.h"
+#include "../src/Layout/Arena.h"
+#include "../src/Layout/Layout.h"
+#include "../src/Apps/Alerts/AlertsApp.h"
+#include "../src/Apps/About/About.h"
+#include "../src/Apps/Calendar/CalendarApp.h"
+#include "../src/Apps/HomeApp/HomeApp.h"
+#include "../src/Apps/Menu/MenuApp.h"
+#include "../src/Apps/Stopwatch/Stopwatch.h"
+#include "../src/Apps/Timer/Timer.h"
+#include "../src/Apps/Tools/Tools.h"
+#include "../src/Watchy/RowCopy.h"
+
+#ifndef FIXTURE_DIR
+#define FIXTURE_DIR "fixtures"
+#endif
+
+// every general heap allocation is counted, to compare with the arena.
+namespace {
+uint64_t heapAllocations;
+} // namespace
+
+void *operator new(size_t size) {
+  heapAllocations++;
+  void *p = malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t size) noexcept { free(p); }
+
+namespace {
+
+// the recorded state is from a calendar fetch at 10:17am EDT on
+// Wednesday, March 12th 2025.
+const time_t BENCH_TIME     = 1741789020;
+const time_t BENCH_TZOFFSET = -4 * 60 * 60;
+
+LocationConfig locations[] = {
+    {
+        .name          = "Home",
+        .weatherURL    = "http://weather.test/data/2.5/weather",
+        .airQualityURL = "http://airquality.test/v1/sensors/1234",
+    },
+};
+
+CalendarSettings calSettings{
+    .calendarAccountURL     = "http://calendar.test/v0/account/bench",
+    .metric                 = false,
+    .silenceWindowHourStart = 22,
+    .silenceWindowHourEnd   = 6,
+    .locations              = locations,
+    .locationCount          = sizeof(locations) / sizeof(locations[0]),
+};
+
+WatchySettings watchSettings{
+    .networkFetchIntervalSeconds = 60 * 60,
+    .networkFetchTries           = 3,
+    .wifiNetworks                = NULL,
+    .wifiNetworkCount            = 0,
+    .defaultTimezoneOffset       = BENCH_TZOFFSET,
+    .buttonConfig                = BUTTONS_SELECT_BACK_LEFT,
+    .fullVoltage                 = 4.2,
+    .emptyVoltage                = 3.2,
+    .darkMode                    = false,
+};
+
+menuAppMemory rootMenuMem;
+menuAppMemory toolMenuMem;
+homeAppMemory rootMem;
+
+Display display(WatchyDisplay{});
+
+String readFixture(const char *name) {
+  std::string path = std::string(FIXTURE_DIR) + "/" + name;
+  FILE *fh         = fopen(path.c_str(), "rb");
+  if (!fh) {
+    fprintf(stderr, "unable to open %s\n", path.c_str());
+    exit(1);
+  }
+  std::string data;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fh)) > 0) {
+    data.append(buf, n);
+  }
+  fclose(fh);
+  return String(data.data(), data.size());
+}
+
+uint32_t framebufferHash() {
+  // FNV-1a, so a change that alters the picture is easy to spot.
+  const uint8_t *buf = display.buffer();
+  uint32_t hash      = 2166136261u;
+  for (size_t i = 0; i < WatchyDisplay::WIDTH / 8 * WatchyDisplay::HEIGHT;
+       i++) {
+    hash = (hash ^ buf[i]) * 16777619u;
+  }
+  return hash;
+}
+
+void writePBM(const char *outdir, const char *name) {
+  std::string path = std::string(outdir) + "/" + name + ".pbm";
+  FILE *fh         = fopen(path.c_str(), "wb");
+  if (!fh) {
+    fprintf(stderr, "unable to write %s\n", path.c_str());
+    exit(1);
+  }
+  fprintf(fh, "P4\n%d %d\n", WatchyDisplay::WIDTH, WatchyDisplay::HEIGHT);
+  // GxEPD2 stores white as 1, PBM stores black as 1.
+  const uint8_t *buf = display.buffer();
+  for (size_t i = 0; i < WatchyDisplay::WIDTH / 8 * WatchyDisplay::HEIGHT;
+       i++) {
+    fputc(buf[i] ^ 0xFF, fh);
+  }
+  fclose(fh);
+}
+
+// damageBytes is how much of the framebuffer a refresh of layoutDamage would
+// send to the display, since windows are sent in whole bytes.
+size_t damageBytes() {
+  if (layoutDamage.width == 0 || layoutDamage.height == 0) {
+    return 0;
+  }
+  int16_t x0 = layoutDamage.x & ~7;
+  int16_t x1 = (layoutDamage.x + layoutDamage.width + 7) & ~7;
+  return (x1 - x0) / 8 * layoutDamage.height;
+}
+
+void run(const char *name, Watchy *watchy, WatchyApp *app, int frames,
+         const char *outdir) {
+  // one untimed frame first so the first call's one-off costs don't count.
+  // anything an App keeps from it, such as a retained layout tree, is pinned
+  // by the App.
+  LayoutElement::startFrame();
+  app->show(watchy, &display);
+
+  size_t arenaBytes = 0;
+
+  LayoutStats layout = {};
+  GFXStats gfx       = {};
+  display.stats      = gfx;
+  uint64_t heap      = heapAllocations;
+  uint64_t damage    = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; i++) {
+    // the same scope Watchy::updateScreen puts around show().
+    ArenaMark frame(globalArena);
+    LayoutElement::startFrame();
+    app->show(watchy, &display);
+    layout.measureCalls += layoutStats.measureCalls;
+    layout.sizeCalls += layoutStats.sizeCalls;
+    layout.drawCalls += layoutStats.drawCalls;
+    damage += damageBytes();
+    if (frame.peak() > arenaBytes) {
+      arenaBytes = frame.peak();
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  gfx          = display.stats;
+  heap         = heapAllocations - heap;
+
+  double nsPerFrame =
+      (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+          .count() /
+      frames;
+  printf("%-16s %10.0f %8.1f %8.1f %8.1f %8.1f %8.1f %9.0f %8zu %8.1f %8.0f   "
+         "%08x\n",
+         name, nsPerFrame, (double)layout.measureCalls / frames,
+         (double)layout.sizeCalls / frames, (double)layout.drawCalls / frames,
+         (double)gfx.textBounds / frames, (double)gfx.glyphs / frames,
+         (double)gfx.pixels / frames, arenaBytes, (double)heap / frames,
+         (double)damage / frames, framebufferHash());
+
+  if (outdir) {
+    writePBM(outdir, name);
+  }
+}
+
+// scenario runs an App that keeps nothing in the arena between frames.
+void scenario(const char *name, Watchy *watchy, WatchyApp *app, int frames,
+              const char *outdir) {
+  ArenaMark mark(globalArena);
+  run(name, watchy, app, frames, outdir);
+}
+
+// calendarScenario runs a fresh CalendarApp, like every wakeup does. The
+// calendar state itself lives in RTC memory, so it carries over, but the
+// layout tree the App keeps is given back along with the App.
+void calendarScenario(const char *name, Watchy *watchy, AlertsApp *alerts,
+                      int frames, const char *outdir) {
+  size_t mark = globalArena.used();
+  {
+    CalendarApp app(calSettings, alerts);
+    run(name, watchy, &app, frames, outdir);
+  }
+  globalArena.unpin(mark);
+  globalArena.rewind(mark);
+}
+
+// the panel's controller memory, standing in for the far end of the SPI bus.
+uint8_t panelRAM[WatchyDisplay::WIDTH / 8 * WatchyDisplay::HEIGHT];
+size_t panelPos;
+
+__attribute__((noinline)) void transferByte(uint8_t data) {
+  panelRAM[panelPos++] = data;
+}
+
+__attribute__((noinline)) void transferBytes(const uint8_t *data, size_t n) {
+  memcpy(panelRAM + panelPos, data, n);
+  panelPos += n;
+}
+
+// sendBytes is how WatchyDisplay used to send a bitmap: one byte at a time.
+void sendBytes(const uint8_t *bitmap, bool invert) {
+  const int16_t wb = WatchyDisplay::WIDTH / 8;
+  for (int16_t i = 0; i < WatchyDisplay::HEIGHT; i++) {
+    for (int16_t j = 0; j < wb; j++) {
+      uint8_t data = bitmap[j + i * wb];
+      if (invert)
+        data = ~data;
+      transferByte(data);
+    }
+  }
+}
+
+// sendRows is how it sends one now, a row or the whole bitmap at a time.
+void sendRows(const uint8_t *bitmap, bool invert) {
+  const int16_t wb = WatchyDisplay::WIDTH / 8;
+  if (!invert) {
+    transferBytes(bitmap, wb * WatchyDisplay::HEIGHT);
+    return;
+  }
+  uint8_t row[wb];
+  for (int16_t i = 0; i < WatchyDisplay::HEIGHT; i++) {
+    copyRow(row, bitmap + i * wb, wb, invert);
+    transferBytes(row, wb);
+  }
+}
+
+// transfer times sending the last frame drawn to the panel.
+void transfer(const char *name, void (*send)(const uint8_t *, bool),
+              bool invert, int frames) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; i++) {
+    panelPos = 0;
+    send(display.buffer(), invert);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < sizeof(panelRAM); i++) {
+    hash = (hash ^ panelRAM[i]) * 16777619u;
+  }
+  printf("%-16s %10.0f   %08x\n", name,
+         (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                 .count() /
+             frames,
+         hash);
+}
+
+// fetch times CalendarApp's network fetch with the calendar server answering
+// with fixture, counting the HTTP requests each fetch made, then hashes the
+// calendar drawn from what was fetched. If etag is set, every fetch after the
+// first one is answered with a 304.
+void fetch(const char *name, Watchy *watchy, const char *fixture,
+           const char *etag, int frames) {
+  HTTPClient::serve("http://calendar.test/", 200, readFixture(fixture), etag);
+  size_t mark = globalArena.used();
+  {
+    CalendarApp app(calSettings);
+    uint64_t heap     = heapAllocations;
+    uint32_t requests = HTTPClient::requests;
+    auto start        = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+      if (app.fetchNetwork(watchy) == FETCH_TRYAGAIN) {
+        fprintf(stderr, "fetching %s failed\n", fixture);
+        exit(1);
+      }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    heap         = heapAllocations - heap;
+    requests     = HTTPClient::requests - requests;
+
+    ArenaMark frame(globalArena);
+    LayoutElement::startFrame();
+    app.show(watchy, &display);
+    printf("%-16s %10.0f %8.1f %8.2f   %08x\n", name,
+           (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               elapsed)
+                   .count() /
+               frames,
+           (double)heap / frames, (double)requests / frames,
+           framebufferHash());
+  }
+  globalArena.unpin(mark);
+  globalArena.rewind(mark);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int frames         = 2000;
+  const char *outdir = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (std::string(argv[i]) == "-n" && i + 1 < argc) {
+      frames = atoi(argv[++i]);
+    } else if (std::string(argv[i]) == "-o" && i + 1 < argc) {
+      outdir = argv[++i];
+    } else {
+      fprintf(stderr, "usage: %s [-n frames] [-o outdir]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (frames <= 0) {
+    frames = 1;
+  }
+
+  HTTPClient::serve("http://weather.test/", 200,
+                    readFixture("weather.json"));
+  HTTPClient::serve("http://airquality.test/", 200,
+                    readFixture("airquality.json"));
+  // calendar.bin is calendar.json in the server's binary wire format, from
+  // watchy_server/main.py's encode_events().
+  HTTPClient::serve("http://calendar.test/", 200,
+                    readFixture("calendar.bin"));
+
+  AlertsApp alerts;
+  CalendarApp calApp(calSettings, &alerts);
+  AboutApp about;
+  TriggerNetworkFetchApp netFetch;
+  TriggerCalendarResetApp calReset(&calApp);
+  ResetStepCounterApp resetSteps;
+  StopwatchApp stopwatch;
+  TimerApp timer(&alerts);
+
+  MenuApp toolMenu(&toolMenuMem, "Tools",
+                   {
+                       MenuItem("Network Fetch", &netFetch),
+                       MenuItem("Calendar Reset", &calReset),
+                       MenuItem("Reset Steps", &resetSteps),
+                   });
+
+  MenuApp rootMenu(&rootMenuMem, "Menu",
+                   {
+                       MenuItem("Timer", &timer),
+                       MenuItem("Stopwatch", &stopwatch),
+                       MenuItem("Tools", &toolMenu),
+                       MenuItem("About", &about),
+                   });
+
+  HomeApp root(&rootMem, &calApp, &rootMenu);
+  alerts.setApp(&root);
+
+  BenchWatchy watchy(BENCH_TIME, BENCH_TZOFFSET, watchSettings);
+  fakeSensors.lastSuccessfulNetworkFetch = BENCH_TIME - 17 * 60;
+  fakeSensors.nextNetworkFetch           = BENCH_TIME + 13 * 60;
+  fakeSensors.nextNetworkFetchReasons    = FETCH_REASON_BUSY;
+
+  alerts.reset(&watchy);
+  if (alerts.fetchNetwork(&watchy) == FETCH_TRYAGAIN) {
+    fprintf(stderr, "fetching the fixtures failed\n");
+    return 1;
+  }
+
+  printf("%d frames per scenario\n\n", frames);
+  printf("%-16s %10s %8s %8s %8s %8s %8s %9s %8s %8s %8s   %s\n", "scenario",
+         "ns/frame", "measure", "size", "draw", "bounds", "glyphs", "pixels",
+         "arena", "heap", "damage", "fb hash");
+
+  calendarScenario("calendar", &watchy, &alerts, frames, outdir);
+  calApp.buttonDown(&watchy);
+  calendarScenario("calendar-full", &watchy, &alerts, frames, outdir);
+  calApp.buttonDown(&watchy);
+  calApp.buttonDown(&watchy);
+  calendarScenario("calendar-later", &watchy, &alerts, frames, outdir);
+  calApp.buttonBack(&watchy);
+  calApp.buttonBack(&watchy);
+  calendarScenario("calendar-month", &watchy, &alerts, frames, outdir);
+  calApp.buttonBack(&watchy);
+
+  scenario("menu", &watchy, &rootMenu, frames, outdir);
+  scenario("about", &watchy, &about, frames, outdir);
+  about.buttonDown(&watchy);
+  scenario("about-profile", &watchy, &about, frames, outdir);
+  about.buttonUp(&watchy);
+  scenario("stopwatch", &watchy, &stopwatch, frames, outdir);
+  scenario("timer", &watchy, &timer, frames, outdir);
+
+  alerts.addAlert("Leave for pickup", BENCH_TIME);
+  scenario("alerts", &watchy, &alerts, frames, outdir);
+
+  printf("\n%-16s %10s   %s\n", "transfer", "ns/frame", "panel hash");
+  transfer("bytes", sendBytes, false, frames);
+  transfer("rows", sendRows, false, frames);
+  transfer("bytes-invert", sendBytes, true, frames);
+  transfer("rows-invert", sendRows, true, frames);
+
+  printf("\n%-16s %10s %8s %8s   %s\n", "fetch", "ns/fetch", "heap",
+         "requests", "fb hash");
+  fetch("json", &watchy, "calendar.json", NULL, frames);
+  fetch("binary", &watchy, "calendar.bin", NULL, frames);
+  fetch("binary-etag", &watchy, "calendar.bin", "\"bench\"", frames);
+  // calendar-weather.bin also has weather.json and airquality.json in it, as
+  // the server sends them for a location it has them for.
+  fetch("binary-weather", &watchy, "calendar-weather.bin", NULL, frames);
+
+  return 0;
+}
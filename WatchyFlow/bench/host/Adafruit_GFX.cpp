@@ -0,0 +1,236 @@
+#include "Adafruit_GFX.h"
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h)
+    : stats(), WIDTH(w), HEIGHT(h), _width(w), _height(h), cursor_x(0),
+      cursor_y(0), textcolor(0xFFFF), textbgcolor(0xFFFF), textsize_x(1),
+      textsize_y(1), rotation(0), wrap(true), _cp437(false), gfxFont(NULL) {}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                 uint16_t color) {
+  for (int16_t i = 0; i < h; i++) {
+    drawPixel(x, y + i, color);
+  }
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                 uint16_t color) {
+  for (int16_t i = 0; i < w; i++) {
+    drawPixel(x + i, y, color);
+  }
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color) {
+  for (int16_t i = 0; i < w; i++) {
+    drawFastVLine(x + i, y, h, color);
+  }
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+  fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+                              int16_t w, int16_t h, uint16_t color) {
+  int16_t byteWidth = (w + 7) / 8;
+  uint8_t b         = 0;
+  for (int16_t j = 0; j < h; j++, y++) {
+    for (int16_t i = 0; i < w; i++) {
+      if (i & 7) {
+        b <<= 1;
+      } else {
+        b = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
+      }
+      if (b & 0x80) {
+        drawPixel(x + i, y, color);
+      }
+    }
+  }
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
+                            uint16_t color, uint16_t bg, uint8_t size_x,
+                            uint8_t size_y) {
+  stats.glyphs++;
+  if (!gfxFont) {
+    // placeholder glyphs for the built-in font: a 5x7 pattern derived from
+    // the character code, which costs about as much to draw as the real one.
+    for (int8_t i = 0; i < 5; i++) {
+      uint8_t line = (uint8_t)(c * (i + 7)) ^ (0x55 << (i & 1));
+      for (int8_t j = 0; j < 7; j++, line >>= 1) {
+        if (line & 1) {
+          drawPixel(x + i, y + j, color);
+        }
+      }
+    }
+    return;
+  }
+
+  c -= (uint8_t)gfxFont->first;
+  GFXglyph *glyph = &gfxFont->glyph[c];
+  uint8_t *bitmap = gfxFont->bitmap;
+  uint16_t bo     = glyph->bitmapOffset;
+  uint8_t w = glyph->width, h = glyph->height;
+  int8_t xo = glyph->xOffset, yo = glyph->yOffset;
+  uint8_t bits = 0, bit = 0;
+  for (uint8_t yy = 0; yy < h; yy++) {
+    for (uint8_t xx = 0; xx < w; xx++) {
+      if (!(bit++ & 7)) {
+        bits = bitmap[bo++];
+      }
+      if (bits & 0x80) {
+        drawPixel(x + xo + xx, y + yo + yy, color);
+      }
+      bits <<= 1;
+    }
+  }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (!gfxFont) {
+    if (c == '\n') {
+      cursor_x = 0;
+      cursor_y += textsize_y * 8;
+    } else if (c != '\r') {
+      if (wrap && ((cursor_x + textsize_x * 6) > _width)) {
+        cursor_x = 0;
+        cursor_y += textsize_y * 8;
+      }
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x,
+               textsize_y);
+      cursor_x += textsize_x * 6;
+    }
+    return 1;
+  }
+
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += (int16_t)textsize_y * gfxFont->yAdvance;
+  } else if (c != '\r') {
+    if ((c >= gfxFont->first) && (c <= gfxFont->last)) {
+      GFXglyph *glyph = &gfxFont->glyph[c - gfxFont->first];
+      if ((glyph->width > 0) && (glyph->height > 0)) {
+        int16_t xo = glyph->xOffset;
+        if (wrap && ((cursor_x + textsize_x * (xo + glyph->width)) > _width)) {
+          cursor_x = 0;
+          cursor_y += (int16_t)textsize_y * gfxFont->yAdvance;
+        }
+        drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x,
+                 textsize_y);
+      }
+      cursor_x += glyph->xAdvance * (int16_t)textsize_x;
+    }
+  }
+  return 1;
+}
+
+void Adafruit_GFX::setRotation(uint8_t r) {
+  rotation = (r & 3);
+  switch (rotation) {
+  case 0:
+  case 2:
+    _width  = WIDTH;
+    _height = HEIGHT;
+    break;
+  case 1:
+  case 3:
+    _width  = HEIGHT;
+    _height = WIDTH;
+    break;
+  }
+}
+
+void Adafruit_GFX::charBounds(unsigned char c, int16_t *x, int16_t *y,
+                              int16_t *minx, int16_t *miny, int16_t *maxx,
+                              int16_t *maxy) {
+  if (gfxFont) {
+    if (c == '\n') {
+      *x = 0;
+      *y += textsize_y * gfxFont->yAdvance;
+    } else if (c != '\r') {
+      if ((c >= gfxFont->first) && (c <= gfxFont->last)) {
+        GFXglyph *glyph = &gfxFont->glyph[c - gfxFont->first];
+        uint8_t gw = glyph->width, gh = glyph->height, xa = glyph->xAdvance;
+        int8_t xo = glyph->xOffset, yo = glyph->yOffset;
+        if (wrap && ((*x + (((int16_t)xo + gw) * textsize_x)) > _width)) {
+          *x = 0;
+          *y += textsize_y * gfxFont->yAdvance;
+        }
+        int16_t tsx = (int16_t)textsize_x, tsy = (int16_t)textsize_y,
+                x1 = *x + xo * tsx, y1 = *y + yo * tsy, x2 = x1 + gw * tsx - 1,
+                y2 = y1 + gh * tsy - 1;
+        if (x1 < *minx) {
+          *minx = x1;
+        }
+        if (y1 < *miny) {
+          *miny = y1;
+        }
+        if (x2 > *maxx) {
+          *maxx = x2;
+        }
+        if (y2 > *maxy) {
+          *maxy = y2;
+        }
+        *x += xa * tsx;
+      }
+    }
+    return;
+  }
+
+  if (c == '\n') {
+    *x = 0;
+    *y += textsize_y * 8;
+  } else if (c != '\r') {
+    if (wrap && ((*x + textsize_x * 6) > _width)) {
+      *x = 0;
+      *y += textsize_y * 8;
+    }
+    int x2 = *x + textsize_x * 6 - 1, y2 = *y + textsize_y * 8 - 1;
+    if (x2 > *maxx) {
+      *maxx = x2;
+    }
+    if (y2 > *maxy) {
+      *maxy = y2;
+    }
+    if (*x < *minx) {
+      *minx = *x;
+    }
+    if (*y < *miny) {
+      *miny = *y;
+    }
+    *x += textsize_x * 6;
+  }
+}
+
+void Adafruit_GFX::getTextBounds(const char *str, int16_t x, int16_t y,
+                                 int16_t *x1, int16_t *y1, uint16_t *w,
+                                 uint16_t *h) {
+  stats.textBounds++;
+  uint8_t c;
+  int16_t minx = 0x7FFF, miny = 0x7FFF, maxx = -1, maxy = -1;
+
+  *x1 = x;
+  *y1 = y;
+  *w = *h = 0;
+
+  while ((c = *str++)) {
+    charBounds(c, &x, &y, &minx, &miny, &maxx, &maxy);
+  }
+
+  if (maxx >= minx) {
+    *x1 = minx;
+    *w  = maxx - minx + 1;
+  }
+  if (maxy >= miny) {
+    *y1 = miny;
+    *h  = maxy - miny + 1;
+  }
+}
+
+void Adafruit_GFX::getTextBounds(const String &str, int16_t x, int16_t y,
+                                 int16_t *x1, int16_t *y1, uint16_t *w,
+                                 uint16_t *h) {
+  if (str.length() != 0) {
+    getTextBounds(str.c_str(), x, y, x1, y1, w, h);
+  }
+}
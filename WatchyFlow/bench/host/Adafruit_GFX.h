@@ -0,0 +1,84 @@
+#pragma once
+
+// A stand-in for Adafruit_GFX. Text measurement and glyph rendering follow the
+// real library's algorithms so that layout sizes match the watch, but the
+// built-in 6x8 font is replaced by generated placeholder glyphs.
+//
+// It also counts the work done so the benchmark can report it.
+
+#include "Arduino.h"
+#include "gfxfont.h"
+
+typedef struct GFXStats {
+  uint32_t glyphs;     // characters rendered
+  uint32_t textBounds; // getTextBounds() calls
+  uint32_t pixels;     // pixels written
+} GFXStats;
+
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h);
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                        uint16_t color);
+  virtual void fillScreen(uint16_t color);
+
+  void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w,
+                  int16_t h, uint16_t color);
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                uint16_t bg, uint8_t size_x, uint8_t size_y);
+
+  void getTextBounds(const char *string, int16_t x, int16_t y, int16_t *x1,
+                     int16_t *y1, uint16_t *w, uint16_t *h);
+  void getTextBounds(const String &str, int16_t x, int16_t y, int16_t *x1,
+                     int16_t *y1, uint16_t *w, uint16_t *h);
+
+  void setTextSize(uint8_t s) { textsize_x = textsize_y = s > 0 ? s : 1; }
+  void setFont(const GFXfont *f) { gfxFont = (GFXfont *)f; }
+  void setCursor(int16_t x, int16_t y) {
+    cursor_x = x;
+    cursor_y = y;
+  }
+  void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+  void setTextColor(uint16_t c, uint16_t bg) {
+    textcolor   = c;
+    textbgcolor = bg;
+  }
+  void setTextWrap(bool w) { wrap = w; }
+  void cp437(bool x = true) { _cp437 = x; }
+  void setRotation(uint8_t r);
+
+  using Print::write;
+  size_t write(uint8_t c) override;
+
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+  uint8_t getRotation() const { return rotation; }
+  int16_t getCursorX() const { return cursor_x; }
+  int16_t getCursorY() const { return cursor_y; }
+
+  GFXStats stats;
+
+protected:
+  void charBounds(unsigned char c, int16_t *x, int16_t *y, int16_t *minx,
+                  int16_t *miny, int16_t *maxx, int16_t *maxy);
+
+  int16_t WIDTH;
+  int16_t HEIGHT;
+  int16_t _width;
+  int16_t _height;
+  int16_t cursor_x;
+  int16_t cursor_y;
+  uint16_t textcolor;
+  uint16_t textbgcolor;
+  uint8_t textsize_x;
+  uint8_t textsize_y;
+  uint8_t rotation;
+  bool wrap;
+  bool _cp437;
+  GFXfont *gfxFont;
+};
@@ -0,0 +1,220 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+namespace {
+const auto start = std::chrono::steady_clock::now();
+
+std::string formatInteger(unsigned long long value, bool negative,
+                          unsigned char base) {
+  if (base < 2 || base > 36) {
+    base = 10;
+  }
+  char buf[8 * sizeof(value) + 2];
+  char *p = &buf[sizeof(buf) - 1];
+  *p      = 0;
+  do {
+    unsigned digit = value % base;
+    *--p           = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while (value > 0);
+  if (negative) {
+    *--p = '-';
+  }
+  return p;
+}
+
+std::string formatSigned(long long value, unsigned char base) {
+  if (value < 0 && base == 10) {
+    return formatInteger(-(unsigned long long)value, true, base);
+  }
+  return formatInteger((unsigned long long)value, false, base);
+}
+
+std::string formatFloat(double value, unsigned int decimalPlaces) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  return buf;
+}
+} // namespace
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {}
+
+String::String(const char *cstr) : buf_(cstr ? cstr : "") {}
+String::String(char c) : buf_(1, c) {}
+String::String(unsigned char value, unsigned char base)
+    : buf_(formatInteger(value, false, base)) {}
+String::String(int value, unsigned char base)
+    : buf_(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base)
+    : buf_(formatInteger(value, false, base)) {}
+String::String(long value, unsigned char base)
+    : buf_(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base)
+    : buf_(formatInteger(value, false, base)) {}
+String::String(float value, unsigned int decimalPlaces)
+    : buf_(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces)
+    : buf_(formatFloat(value, decimalPlaces)) {}
+
+char &String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= buf_.size()) {
+    dummy = 0;
+    return dummy;
+  }
+  return buf_[index];
+}
+
+String String::substring(unsigned int beginIndex) const {
+  return substring(beginIndex, buf_.size());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex) {
+    unsigned int swap = beginIndex;
+    beginIndex        = endIndex;
+    endIndex          = swap;
+  }
+  if (beginIndex >= buf_.size()) {
+    return String();
+  }
+  if (endIndex > buf_.size()) {
+    endIndex = buf_.size();
+  }
+  return String(buf_.substr(beginIndex, endIndex - beginIndex).c_str());
+}
+
+int String::indexOf(char ch) const {
+  size_t pos = buf_.find(ch);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String &str) const {
+  size_t pos = buf_.find(str.buf_);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+void String::replace(const String &find, const String &replace) {
+  if (find.buf_.empty()) {
+    return;
+  }
+  size_t pos = 0;
+  while ((pos = buf_.find(find.buf_, pos)) != std::string::npos) {
+    buf_.replace(pos, find.buf_.size(), replace.buf_);
+    pos += replace.buf_.size();
+  }
+}
+
+void String::trim() {
+  size_t begin = buf_.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) {
+    buf_.clear();
+    return;
+  }
+  size_t end = buf_.find_last_not_of(" \t\r\n");
+  buf_       = buf_.substr(begin, end - begin + 1);
+}
+
+void String::toCharArray(char *buf, unsigned int bufsize,
+                         unsigned int index) const {
+  if (!bufsize || !buf) {
+    return;
+  }
+  if (index >= buf_.size()) {
+    buf[0] = 0;
+    return;
+  }
+  unsigned int n = bufsize - 1;
+  if (n > buf_.size() - index) {
+    n = buf_.size() - index;
+  }
+  memcpy(buf, buf_.data() + index, n);
+  buf[n] = 0;
+}
+
+long String::toInt() const { return atol(buf_.c_str()); }
+
+String operator+(const String &lhs, const String &rhs) {
+  String rv(lhs);
+  rv += rhs;
+  return rv;
+}
+
+String operator+(const String &lhs, const char *rhs) {
+  String rv(lhs);
+  rv += rhs;
+  return rv;
+}
+
+String operator+(const char *lhs, const String &rhs) {
+  String rv(lhs);
+  rv += rhs;
+  return rv;
+}
+
+String operator+(const String &lhs, char rhs) {
+  String rv(lhs);
+  rv += rhs;
+  return rv;
+}
+
+size_t Print::write(const char *str) {
+  return write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::print(const String &s) { return write(s.c_str()); }
+size_t Print::print(const char *s) { return write(s); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char n, int base) {
+  return print(String(n, base));
+}
+size_t Print::print(int n, int base) { return print(String(n, base)); }
+size_t Print::print(unsigned int n, int base) {
+  return print(String(n, base));
+}
+size_t Print::print(long n, int base) { return print(String(n, base)); }
+size_t Print::print(unsigned long n, int base) {
+  return print(String(n, base));
+}
+size_t Print::print(double n, int digits) { return print(String(n, digits)); }
+size_t Print::println() { return write("\r\n"); }
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t n = 0;
+  for (; n < length; n++) {
+    int c = read();
+    if (c < 0) {
+      break;
+    }
+    buffer[n] = c;
+  }
+  return n;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+// A small stand-in for the parts of the Arduino core that the Layout, Elements
+// and Apps code uses, so it can be compiled and benchmarked on a Linux host.
+// It is not a complete or exact implementation.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+
+#define RTC_DATA_ATTR
+#define PROGMEM
+#define pgm_read_byte(addr)    (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)    (*(const uint16_t *)(addr))
+#define pgm_read_pointer(addr) ((void *)*(void **)(addr))
+
+#define DEC 10
+#define HEX 16
+
+#define LOW  0
+#define HIGH 1
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+class String {
+public:
+  String(const char *cstr = "");
+  String(const char *cstr, unsigned int length) : buf_(cstr, length) {}
+  String(const String &str) : buf_(str.buf_) {}
+  explicit String(char c);
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(float value, unsigned int decimalPlaces = 2);
+  explicit String(double value, unsigned int decimalPlaces = 2);
+
+  String &operator=(const String &rhs) {
+    buf_ = rhs.buf_;
+    return *this;
+  }
+  String &operator=(const char *cstr) {
+    buf_ = cstr ? cstr : "";
+    return *this;
+  }
+
+  String &operator+=(const String &rhs) {
+    buf_ += rhs.buf_;
+    return *this;
+  }
+  String &operator+=(const char *cstr) {
+    buf_ += cstr ? cstr : "";
+    return *this;
+  }
+  String &operator+=(char c) {
+    buf_ += c;
+    return *this;
+  }
+  String &operator+=(unsigned char num) { return *this += String(num); }
+  String &operator+=(int num) { return *this += String(num); }
+  String &operator+=(unsigned int num) { return *this += String(num); }
+  String &operator+=(long num) { return *this += String(num); }
+  String &operator+=(unsigned long num) { return *this += String(num); }
+  String &operator+=(float num) { return *this += String(num); }
+  String &operator+=(double num) { return *this += String(num); }
+
+  bool operator==(const String &rhs) const { return buf_ == rhs.buf_; }
+  bool operator==(const char *cstr) const { return buf_ == cstr; }
+  bool operator!=(const String &rhs) const { return buf_ != rhs.buf_; }
+  bool operator!=(const char *cstr) const { return buf_ != cstr; }
+
+  char operator[](unsigned int index) const {
+    return index < buf_.size() ? buf_[index] : 0;
+  }
+  char &operator[](unsigned int index);
+  char charAt(unsigned int index) const { return (*this)[index]; }
+
+  unsigned int length() const { return buf_.size(); }
+  const char *c_str() const { return buf_.c_str(); }
+  bool reserve(unsigned int size) {
+    buf_.reserve(size);
+    return true;
+  }
+
+  String substring(unsigned int beginIndex) const;
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+  int indexOf(char ch) const;
+  int indexOf(const String &str) const;
+  void replace(const String &find, const String &replace);
+  void trim();
+  void toCharArray(char *buf, unsigned int bufsize,
+                   unsigned int index = 0) const;
+  long toInt() const;
+
+private:
+  std::string buf_;
+};
+
+String operator+(const String &lhs, const String &rhs);
+String operator+(const String &lhs, const char *rhs);
+String operator+(const char *lhs, const String &rhs);
+String operator+(const String &lhs, char rhs);
+
+// Print is the base class of anything you can print() to, such as the display.
+class Print {
+public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t c) = 0;
+  size_t write(const char *str);
+  size_t write(const uint8_t *buffer, size_t size);
+
+  size_t print(const String &s);
+  size_t print(const char *s);
+  size_t print(char c);
+  size_t print(unsigned char n, int base = DEC);
+  size_t print(int n, int base = DEC);
+  size_t print(unsigned int n, int base = DEC);
+  size_t print(long n, int base = DEC);
+  size_t print(unsigned long n, int base = DEC);
+  size_t print(double n, int digits = 2);
+
+  size_t println();
+  template <typename T> size_t println(const T &value) {
+    size_t n = print(value);
+    return n + println();
+  }
+};
+
+// Stream is the base class of anything that can be read from, such as a
+// network connection.
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read()      = 0;
+
+  void setTimeout(unsigned long timeout) {}
+  size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length) {
+    return readBytes((char *)buffer, length);
+  }
+};
@@ -0,0 +1,243 @@
+#include "Arduino_JSON.h"
+
+#include <stdlib.h>
+
+struct JSONVar::Node {
+  enum Type { UNDEFINED, NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+  Node() : type(UNDEFINED), number(0) {}
+
+  Type type;
+  double number;
+  std::string str;
+  std::vector<JSONVar> items;
+  std::vector<std::pair<std::string, JSONVar>> fields;
+};
+
+JSONClass JSON;
+
+class JSONParser {
+public:
+  explicit JSONParser(const char *p) : p_(p) {}
+
+  bool value(JSONVar *out) {
+    skipSpace();
+    out->node_ = std::make_shared<JSONVar::Node>();
+    JSONVar::Node *n = out->node_.get();
+    switch (*p_) {
+    case '{':
+      p_++;
+      n->type = JSONVar::Node::OBJECT;
+      skipSpace();
+      if (*p_ == '}') {
+        p_++;
+        return true;
+      }
+      while (true) {
+        std::string key;
+        skipSpace();
+        if (!string(&key)) {
+          return false;
+        }
+        skipSpace();
+        if (*p_++ != ':') {
+          return false;
+        }
+        JSONVar field;
+        if (!value(&field)) {
+          return false;
+        }
+        n->fields.push_back(std::make_pair(key, field));
+        skipSpace();
+        if (*p_ == ',') {
+          p_++;
+          continue;
+        }
+        return *p_++ == '}';
+      }
+    case '[':
+      p_++;
+      n->type = JSONVar::Node::ARRAY;
+      skipSpace();
+      if (*p_ == ']') {
+        p_++;
+        return true;
+      }
+      while (true) {
+        JSONVar item;
+        if (!value(&item)) {
+          return false;
+        }
+        n->items.push_back(item);
+        skipSpace();
+        if (*p_ == ',') {
+          p_++;
+          continue;
+        }
+        return *p_++ == ']';
+      }
+    case '"':
+      n->type = JSONVar::Node::STRING;
+      return string(&n->str);
+    case 't':
+      n->type   = JSONVar::Node::BOOLEAN;
+      n->number = 1;
+      return literal("true");
+    case 'f':
+      n->type = JSONVar::Node::BOOLEAN;
+      return literal("false");
+    case 'n':
+      n->type = JSONVar::Node::NUL;
+      return literal("null");
+    default: {
+      char *end;
+      n->type   = JSONVar::Node::NUMBER;
+      n->number = strtod(p_, &end);
+      if (end == p_) {
+        return false;
+      }
+      p_ = end;
+      return true;
+    }
+    }
+  }
+
+  bool done() {
+    skipSpace();
+    return *p_ == 0;
+  }
+
+private:
+  void skipSpace() {
+    while (*p_ == ' ' || *p_ == '\t' || *p_ == '\r' || *p_ == '\n') {
+      p_++;
+    }
+  }
+
+  bool literal(const char *word) {
+    size_t n = strlen(word);
+    if (strncmp(p_, word, n) != 0) {
+      return false;
+    }
+    p_ += n;
+    return true;
+  }
+
+  bool string(std::string *out) {
+    if (*p_++ != '"') {
+      return false;
+    }
+    while (*p_ && *p_ != '"') {
+      if (*p_ != '\\') {
+        *out += *p_++;
+        continue;
+      }
+      p_++;
+      switch (*p_) {
+      case 'n':
+        *out += '\n';
+        break;
+      case 't':
+        *out += '\t';
+        break;
+      case 'r':
+        *out += '\r';
+        break;
+      case 'b':
+        *out += '\b';
+        break;
+      case 'f':
+        *out += '\f';
+        break;
+      case 'u': {
+        unsigned long cp = strtoul(std::string(p_ + 1, 4).c_str(), NULL, 16);
+        p_ += 4;
+        if (cp < 0x80) {
+          *out += (char)cp;
+        } else if (cp < 0x800) {
+          *out += (char)(0xC0 | (cp >> 6));
+          *out += (char)(0x80 | (cp & 0x3F));
+        } else {
+          *out += (char)(0xE0 | (cp >> 12));
+          *out += (char)(0x80 | ((cp >> 6) & 0x3F));
+          *out += (char)(0x80 | (cp & 0x3F));
+        }
+        break;
+      }
+      default:
+        *out += *p_;
+        break;
+      }
+      if (*p_) {
+        p_++;
+      }
+    }
+    return *p_++ == '"';
+  }
+
+  const char *p_;
+};
+
+JSONVar::JSONVar() : node_(std::make_shared<Node>()) {}
+
+JSONVar JSONVar::operator[](const char *key) const {
+  for (size_t i = 0; i < node_->fields.size(); i++) {
+    if (node_->fields[i].first == key) {
+      return node_->fields[i].second;
+    }
+  }
+  return JSONVar();
+}
+
+JSONVar JSONVar::operator[](int index) const {
+  if (index < 0 || (size_t)index >= node_->items.size()) {
+    return JSONVar();
+  }
+  return node_->items[index];
+}
+
+bool JSONVar::hasOwnProperty(const char *key) const {
+  for (size_t i = 0; i < node_->fields.size(); i++) {
+    if (node_->fields[i].first == key) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int JSONVar::length() const {
+  if (node_->type == Node::ARRAY) {
+    return node_->items.size();
+  }
+  if (node_->type == Node::OBJECT) {
+    return node_->fields.size();
+  }
+  if (node_->type == Node::STRING) {
+    return node_->str.size();
+  }
+  return -1;
+}
+
+JSONVar::operator bool() const { return node_->number != 0; }
+JSONVar::operator int() const { return (int)node_->number; }
+JSONVar::operator long() const { return (long)node_->number; }
+JSONVar::operator double() const { return node_->number; }
+
+JSONVar::operator String() const {
+  if (node_->type == Node::STRING) {
+    return String(node_->str.c_str());
+  }
+  if (node_->type == Node::NUMBER) {
+    return String(node_->number, 0);
+  }
+  return String("null");
+}
+
+JSONVar JSONClass::parse(const String &str) {
+  JSONVar rv;
+  JSONParser parser(str.c_str());
+  if (!parser.value(&rv) || !parser.done()) {
+    return JSONVar();
+  }
+  return rv;
+}
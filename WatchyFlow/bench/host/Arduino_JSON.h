@@ -0,0 +1,40 @@
+#pragma once
+
+// A stand-in for Arduino_JSON's JSONVar with just the accessors the firmware
+// uses. Parsing is a small recursive descent parser; like the real library,
+// reading a missing key or index gives an undefined value that converts to
+// zero, false or "null".
+
+#include "Arduino.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+class JSONVar {
+public:
+  JSONVar();
+
+  JSONVar operator[](const char *key) const;
+  JSONVar operator[](int index) const;
+  bool hasOwnProperty(const char *key) const;
+  int length() const;
+
+  operator bool() const;
+  operator int() const;
+  operator long() const;
+  operator double() const;
+  operator String() const;
+
+private:
+  friend class JSONParser;
+  struct Node;
+  std::shared_ptr<Node> node_;
+};
+
+class JSONClass {
+public:
+  JSONVar parse(const String &str);
+};
+
+extern JSONClass JSON;
@@ -0,0 +1,8 @@
+#pragma once
+
+// see Picopixel.h.
+namespace host_FreeSans9pt7b {
+#include "../../../src/Fonts/Seven_Segment10pt7b.h"
+}
+
+#define FreeSans9pt7b host_FreeSans9pt7b::Seven_Segment10pt7b
@@ -0,0 +1,11 @@
+#pragma once
+
+// Adafruit GFX's fonts aren't vendored here. The benchmark substitutes one of
+// the firmware's own fonts, so glyph sizes and text metrics differ from the
+// watch, but the layout work done per frame is the same. The firmware's font
+// headers have no include guards, hence the namespace.
+namespace host_picopixel {
+#include "../../../src/Fonts/Seven_Segment10pt7b.h"
+}
+
+#define Picopixel host_picopixel::Seven_Segment10pt7b
@@ -0,0 +1,70 @@
+#pragma once
+
+// A stand-in for GxEPD2_BW: a full-frame 1 bit per pixel framebuffer with the
+// same pixel layout and rotation handling as the real thing. display() and
+// friends only count how often they were called.
+
+#include "Adafruit_GFX.h"
+#include "GxEPD2_EPD.h"
+
+template <typename GxEPD2_Type, const uint16_t page_height>
+class GxEPD2_BW : public Adafruit_GFX {
+public:
+  GxEPD2_Type epd2;
+
+  explicit GxEPD2_BW(GxEPD2_Type epd2_instance)
+      : Adafruit_GFX(GxEPD2_Type::WIDTH_VISIBLE, GxEPD2_Type::HEIGHT),
+        epd2(epd2_instance), displays(0) {
+    memset(_buffer, 0xFF, sizeof(_buffer));
+  }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    stats.pixels++;
+    if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) {
+      return;
+    }
+    int16_t swap;
+    switch (getRotation()) {
+    case 1:
+      swap = x;
+      x    = y;
+      y    = swap;
+      x    = GxEPD2_Type::WIDTH - x - 1;
+      break;
+    case 2:
+      x = GxEPD2_Type::WIDTH - x - 1;
+      y = GxEPD2_Type::HEIGHT - y - 1;
+      break;
+    case 3:
+      swap = x;
+      x    = y;
+      y    = swap;
+      y    = GxEPD2_Type::HEIGHT - y - 1;
+      break;
+    }
+    uint16_t i = x / 8 + y * (GxEPD2_Type::WIDTH / 8);
+    if (color) {
+      _buffer[i] = (_buffer[i] | (1 << (7 - x % 8)));
+    } else {
+      _buffer[i] = (_buffer[i] & (0xFF ^ (1 << (7 - x % 8))));
+    }
+  }
+
+  void fillScreen(uint16_t color) override {
+    memset(_buffer, color ? 0xFF : 0x00, sizeof(_buffer));
+  }
+
+  void setFullWindow() {}
+  void display(bool partial_update_mode = false) { displays++; }
+  void displayWindow(int16_t x, int16_t y, int16_t w, int16_t h) {
+    displays++;
+  }
+  void hibernate() {}
+
+  const uint8_t *buffer() const { return _buffer; }
+
+  uint32_t displays;
+
+private:
+  uint8_t _buffer[(GxEPD2_Type::WIDTH / 8) * page_height];
+};
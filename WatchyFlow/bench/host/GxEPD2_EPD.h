@@ -0,0 +1,30 @@
+#pragma once
+
+// A stand-in for GxEPD2's panel driver base class. On the host there is no
+// panel, so WatchyDisplay only needs to exist as a type.
+
+#include "Arduino.h"
+
+#define GxEPD_BLACK 0x0000
+#define GxEPD_WHITE 0xFFFF
+
+class GxEPD2 {
+public:
+  enum Panel { GDEH0154D67 };
+};
+
+class GxEPD2_EPD {
+public:
+  const uint16_t WIDTH;
+  const uint16_t HEIGHT;
+  const GxEPD2::Panel panel;
+  const bool hasColor;
+  const bool hasPartialUpdate;
+  const bool hasFastPartialUpdate;
+
+  GxEPD2_EPD(int16_t cs, int16_t dc, int16_t rst, int16_t busy,
+             int16_t busy_level, uint32_t busy_timeout, uint16_t w, uint16_t h,
+             GxEPD2::Panel p, bool c, bool pu, bool fpu)
+      : WIDTH(w), HEIGHT(h), panel(p), hasColor(c), hasPartialUpdate(pu),
+        hasFastPartialUpdate(fpu) {}
+};
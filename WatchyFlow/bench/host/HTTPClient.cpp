@@ -0,0 +1,74 @@
+#include "HTTPClient.h"
+
+#include <vector>
+
+namespace {
+struct Response {
+  std::string urlPrefix;
+  int code;
+  String body;
+  String etag;
+};
+
+std::vector<Response> &responses() {
+  static std::vector<Response> rv;
+  return rv;
+}
+} // namespace
+
+uint32_t HTTPClient::requests = 0;
+
+bool HTTPClient::begin(const char *url) {
+  url_         = url;
+  ifNoneMatch_ = "";
+  return true;
+}
+
+void HTTPClient::addHeader(const String &name, const String &value) {
+  if (name == "If-None-Match") {
+    ifNoneMatch_ = value;
+  }
+}
+
+String HTTPClient::header(const char *name) {
+  if (strcmp(name, "ETag") == 0) {
+    return etag_;
+  }
+  return String();
+}
+
+int HTTPClient::GET() {
+  requests++;
+  for (size_t i = responses().size(); i > 0; i--) {
+    const Response &resp = responses()[i - 1];
+    if (strncmp(url_.c_str(), resp.urlPrefix.c_str(), resp.urlPrefix.size()) ==
+        0) {
+      code_ = resp.code;
+      body_ = resp.body;
+      etag_ = resp.etag;
+      if (etag_.length() > 0 && ifNoneMatch_ == etag_) {
+        code_ = HTTP_CODE_NOT_MODIFIED;
+        body_ = "";
+      }
+      stream_.reset(body_);
+      return code_;
+    }
+  }
+  code_ = HTTPC_ERROR_NOT_CONNECTED;
+  body_ = "";
+  etag_ = "";
+  stream_.reset(body_);
+  return code_;
+}
+
+void HTTPClient::serve(const char *urlPrefix, int code, const String &body,
+                       const char *etag) {
+  Response resp;
+  resp.urlPrefix = urlPrefix;
+  resp.code      = code;
+  resp.body      = body;
+  resp.etag      = etag ? etag : "";
+  responses().push_back(resp);
+}
+
+void HTTPClient::clear() { responses().clear(); }
@@ -0,0 +1,68 @@
+#pragma once
+
+// A stand-in for the ESP32 HTTPClient. There's no network on the benchmark
+// host: responses are registered ahead of time with serve() and matched by URL
+// prefix, and every GET() is counted.
+
+#include "Arduino.h"
+
+#define HTTP_CODE_OK              200
+#define HTTP_CODE_NOT_MODIFIED    304
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+
+// BodyStream reads a response body back out of memory.
+class BodyStream : public Stream {
+public:
+  BodyStream() : pos_(0) {}
+
+  void reset(const String &body) {
+    body_ = body;
+    pos_  = 0;
+  }
+  int available() override { return body_.length() - pos_; }
+  int read() override {
+    return pos_ < body_.length() ? (uint8_t)body_[pos_++] : -1;
+  }
+  size_t write(uint8_t c) override { return 0; }
+
+private:
+  String body_;
+  unsigned int pos_;
+};
+
+class HTTPClient {
+public:
+  HTTPClient() : code_(0) {}
+
+  void setConnectTimeout(int32_t connectTimeout) {}
+  void setTimeout(uint16_t timeout) {}
+  void setReuse(bool reuse) {}
+  bool begin(const char *url);
+  bool begin(const String &url) { return begin(url.c_str()); }
+  int GET();
+  void addHeader(const String &name, const String &value);
+  void collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {}
+  String header(const char *name);
+  String getString() { return body_; }
+  int getSize() { return body_.length(); }
+  bool connected() { return stream_.available() > 0; }
+  Stream *getStreamPtr() { return &stream_; }
+  void end() {}
+
+  // serve() makes any GET of a URL starting with urlPrefix return code and
+  // body. Later registrations take precedence. If etag is set, it's sent as
+  // the response's ETag header, and a GET with a matching If-None-Match
+  // header gets a 304 with no body instead.
+  static void serve(const char *urlPrefix, int code, const String &body,
+                    const char *etag = NULL);
+  static void clear();
+  static uint32_t requests;
+
+private:
+  String url_;
+  String ifNoneMatch_;
+  String etag_;
+  int code_;
+  String body_;
+  BodyStream stream_;
+};
@@ -0,0 +1,98 @@
+#include "TimeLib.h"
+
+#include <string.h>
+
+namespace {
+const uint8_t monthDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+const char *const dayNames[]   = {"Err",       "Sunday",   "Monday",
+                                  "Tuesday",   "Wednesday", "Thursday",
+                                  "Friday",    "Saturday"};
+const char *const monthNames[] = {"",        "January",  "February",
+                                  "March",   "April",    "May",
+                                  "June",    "July",     "August",
+                                  "September", "October", "November",
+                                  "December"};
+char buffer[10];
+
+bool leapYear(int year) {
+  year += 1970;
+  return (year > 0) && !(year % 4) && ((year % 100) || !(year % 400));
+}
+
+char *copyName(const char *name, size_t length) {
+  strncpy(buffer, name, length);
+  buffer[length < sizeof(buffer) - 1 ? length : sizeof(buffer) - 1] = 0;
+  return buffer;
+}
+} // namespace
+
+time_t makeTime(const tmElements_t &tm) {
+  time_t seconds = tm.Year * (60 * 60 * 24L * 365);
+  for (int i = 0; i < tm.Year; i++) {
+    if (leapYear(i)) {
+      seconds += 60 * 60 * 24L;
+    }
+  }
+  for (int i = 1; i < tm.Month; i++) {
+    if (i == 2 && leapYear(tm.Year)) {
+      seconds += 60 * 60 * 24L * 29;
+    } else {
+      seconds += 60 * 60 * 24L * monthDays[i - 1];
+    }
+  }
+  seconds += (tm.Day - 1) * 60 * 60 * 24L;
+  seconds += tm.Hour * 60 * 60L;
+  seconds += tm.Minute * 60L;
+  seconds += tm.Second;
+  return seconds;
+}
+
+void breakTime(time_t timeInput, tmElements_t &tm) {
+  uint32_t time = (uint32_t)timeInput;
+  tm.Second     = time % 60;
+  time /= 60;
+  tm.Minute = time % 60;
+  time /= 60;
+  tm.Hour = time % 24;
+  time /= 24;
+  tm.Wday = ((time + 4) % 7) + 1;
+
+  uint8_t year  = 0;
+  unsigned long days = 0;
+  while ((unsigned)(days += (leapYear(year) ? 366 : 365)) <= time) {
+    year++;
+  }
+  tm.Year = year;
+  days -= leapYear(year) ? 366 : 365;
+  time -= days;
+
+  uint8_t month = 0;
+  for (month = 0; month < 12; month++) {
+    uint8_t monthLength = monthDays[month];
+    if (month == 1 && leapYear(year)) {
+      monthLength = 29;
+    }
+    if (time < monthLength) {
+      break;
+    }
+    time -= monthLength;
+  }
+  tm.Month = month + 1;
+  tm.Day   = time + 1;
+}
+
+char *dayStr(uint8_t day) {
+  return copyName(dayNames[day < 8 ? day : 0], 9);
+}
+
+char *dayShortStr(uint8_t day) {
+  return copyName(dayNames[day < 8 ? day : 0], 3);
+}
+
+char *monthStr(uint8_t month) {
+  return copyName(monthNames[month < 13 ? month : 0], 9);
+}
+
+char *monthShortStr(uint8_t month) {
+  return copyName(monthNames[month < 13 ? month : 0], 3);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// A stand-in for the parts of the Time library the Apps use.
+
+#include <time.h>
+#include <stdint.h>
+
+typedef struct {
+  uint8_t Second;
+  uint8_t Minute;
+  uint8_t Hour;
+  uint8_t Wday; // day of week, sunday is day 1
+  uint8_t Day;
+  uint8_t Month;
+  uint8_t Year; // offset from 1970;
+} tmElements_t;
+
+#define tmYearToCalendar(Y) ((Y) + 1970)
+#define CalendarYrToTm(Y)   ((Y) - 1970)
+
+time_t makeTime(const tmElements_t &tm);
+void breakTime(time_t time, tmElements_t &tm);
+
+char *dayStr(uint8_t day);
+char *dayShortStr(uint8_t day);
+char *monthStr(uint8_t month);
+char *monthShortStr(uint8_t month);
@@ -0,0 +1,3 @@
+#pragma once
+
+// nothing from the ESP-IDF GPIO driver is needed on the host.
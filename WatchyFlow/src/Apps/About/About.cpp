@@ -1,14 +1,31 @@
 #include "About.h"
 #include "../../Layout/Arena.h"
+#include "../../Net/Parallel.h"
+#include "../../Watchy/Profile.h"
 
 namespace {
 RTC_DATA_ATTR size_t arenaUsed_;
 RTC_DATA_ATTR size_t arenaRemaining_;
+RTC_DATA_ATTR uint8_t page_;
+
+const uint8_t ABOUT_PAGES = 2;
+
+const struct {
+  FetchReason reason;
+  const char *name;
+} fetchReasonNames[] = {
+    {FETCH_REASON_BUSY, "busy"},      {FETCH_REASON_IDLE, "idle"},
+    {FETCH_REASON_UNCHANGED, "same"}, {FETCH_REASON_BATTERY, "batt"},
+    {FETCH_REASON_FAILED, "failed"},
+};
 } // namespace
 
 void AboutApp::reset(Watchy *watchy) {
   arenaUsed_      = 0;
   arenaRemaining_ = 0;
+  page_           = 0;
+  resetArenaScopePeaks();
+  resetArenaOverflows();
 }
 
 AppState AboutApp::show(Watchy *watchy, Display *display) {
@@ -16,6 +33,10 @@ AppState AboutApp::show(Watchy *watchy, Display *display) {
   display->setTextWrap(true);
   display->setTextColor(watchy->foregroundColor());
   display->setCursor(0, 0);
+  if (page_ == 1) {
+    showProfile(watchy, display);
+    return APP_ACTIVE;
+  }
   display->println("github.com/jtolio/watchyflow");
 
   display->print("batt:       ");
@@ -28,6 +49,39 @@ AppState AboutApp::show(Watchy *watchy, Display *display) {
   display->print("last fetch: ");
   display->println(watchy->lastSuccessfulNetworkFetch());
 
+  // how many minutes until the next fetch, and what moved it from the usual
+  // interval.
+  display->print("next fetch: ");
+  display->print(int(watchy->nextNetworkFetch() - watchy->unixtime()) / 60);
+  display->print("m");
+  uint8_t reasons = watchy->nextNetworkFetchReasons();
+  const char *sep = " ";
+  for (auto &name : fetchReasonNames) {
+    if (reasons & name.reason) {
+      display->print(sep);
+      display->print(name.name);
+      sep = ",";
+    }
+  }
+  display->println();
+
+  // how long each of the last fetch's parallel requests took.
+  display->print("fetch ms:   ");
+  for (uint8_t i = 0; i < lastParallelJobs(); i++) {
+    if (i > 0) {
+      display->print("/");
+    }
+    display->print(lastParallelMillis(i));
+  }
+  display->println();
+
+  // how long WiFi took to connect straight to the last access point, then to
+  // scan for one if that didn't work.
+  display->print("wifi ms:    ");
+  display->print(watchy->wifiMillis(WIFI_STAGE_DIRECT));
+  display->print("/");
+  display->println(watchy->wifiMillis(WIFI_STAGE_SCAN));
+
   display->print("wakeup:     ");
   display->println(watchy->wakeupReason());
 
@@ -45,6 +99,15 @@ AppState AboutApp::show(Watchy *watchy, Display *display) {
   display->println(arenaUsed_);
   display->print("remaining:  ");
   display->println(arenaRemaining_);
+  display->print("show peak:  ");
+  display->println(arenaScopePeak(ARENA_SCOPE_SHOW));
+  display->print("notice peak:");
+  display->println(arenaScopePeak(ARENA_SCOPE_NOTICE));
+  display->print("overflows:  ");
+  display->println(arenaOverflows());
+
+  display->print("skipped:    ");
+  display->println(watchy->skippedRefreshes());
 
   display->print("direction:  ");
   display->println(watchy->direction());
@@ -63,9 +126,51 @@ AppState AboutApp::show(Watchy *watchy, Display *display) {
   return APP_ACTIVE;
 }
 
+void AboutApp::showProfile(Watchy *watchy, Display *display) {
+  // how long each part of a wakeup takes, at least, on average and at most.
+  display->println("wakeup ms:  min/avg/max");
+  for (uint8_t i = 0; i < PROFILE_PHASES; i++) {
+    ProfilePhase phase = (ProfilePhase)i;
+    const char *name   = profilePhaseName(phase);
+    display->print(name);
+    display->print(":");
+    for (size_t pad = strlen(name) + 1; pad < 12; pad++) {
+      display->print(" ");
+    }
+    const ProfileStats &stats = profileStats(phase);
+    display->print(stats.min / 1000);
+    display->print("/");
+    display->print(profileAverage(phase) / 1000);
+    display->print("/");
+    display->println(stats.max / 1000);
+  }
+  display->println();
+
+  // the most recent wakeups, newest first.
+  display->print("last ms:    ");
+  for (uint8_t age = 0; age < profileRecords(); age++) {
+    if (age > 0) {
+      display->print("/");
+    }
+    display->print(profileRecord(age).micros[PROFILE_WAKEUP] / 1000);
+  }
+  display->println();
+}
+
+void AboutApp::buttonUp(Watchy *watchy) {
+  page_ = (page_ + ABOUT_PAGES - 1) % ABOUT_PAGES;
+}
+
+void AboutApp::buttonDown(Watchy *watchy) {
+  page_ = (page_ + 1) % ABOUT_PAGES;
+}
+
 void AboutApp::presleep() {
-  if (globalArena.used() > arenaUsed_) {
-    arenaUsed_      = globalArena.used();
-    arenaRemaining_ = globalArena.remaining();
+  // scopes give their memory back when they end, so what matters is the most
+  // the arena ever held at once.
+  if (globalArena.peak() > arenaUsed_) {
+    arenaUsed_ = globalArena.peak();
+    arenaRemaining_ =
+        globalArena.used() + globalArena.remaining() - globalArena.peak();
   }
 }
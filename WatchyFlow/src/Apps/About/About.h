@@ -6,6 +6,12 @@ class AboutApp : public WatchyApp {
 public:
   void reset(Watchy *watchy) override;
   AppState show(Watchy *watchy, Display *display) override;
+  // up and down flip between the diagnostics and the wakeup profile.
+  void buttonUp(Watchy *watchy) override;
+  void buttonDown(Watchy *watchy) override;
 
   static void presleep();
+
+private:
+  void showProfile(Watchy *watchy, Display *display);
 };
@@ -112,9 +112,11 @@ void AlertsApp::tick(Watchy *watchy) {
   app_->tick(watchy);
   if (alerts_.alarmCount > 0) {
     watchy->queueVibrate(200, 10);
+    // keep reminding every minute until they're dismissed.
+    watchy->addTrigger(watchy->unixtime() + 60);
   }
 }
 
 void AlertsApp::addAlert(String summary, time_t alertTime) {
-  addAlarm(&alerts_, summary, alertTime);
+  addAlarm(&alerts_, summary.c_str(), alertTime);
 }
@@ -13,6 +13,9 @@ public:
   FetchState fetchNetwork(Watchy *watchy) override {
     return app_->fetchNetwork(watchy);
   }
+  FetchPace fetchPace(Watchy *watchy) override {
+    return app_->fetchPace(watchy);
+  }
 
   void reset(Watchy *watchy) override;
   void buttonUp(Watchy *watchy) override;
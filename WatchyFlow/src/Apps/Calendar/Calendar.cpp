@@ -1,5 +1,6 @@
 #include "Calendar.h"
 #include "../../Layout/Layout.h"
+#include "../../Layout/TextMetrics.h"
 #include "../../Watchy/Watchy.h"
 #include "../Alerts/AlertsApp.h"
 #include <Fonts/Picopixel.h>
@@ -12,41 +13,238 @@ const int16_t EVENT_PADDING        = 2;
 const time_t SECONDS_PER_PIXEL =
     SMALLEST_EVENT / ((int32_t)(SMALL_FONT_HEIGHT) + (2 * EVENT_PADDING));
 
-void reset(dayEventsData *data) { data->eventCount = 0; }
+namespace {
+const char TOO_MANY_EVENTS[] = "TOO MANY EVENTS";
+// where TOO_MANY_EVENTS is in an EventPool's text.
+const uint16_t TOO_MANY_EVENTS_AT = 1;
 
-void addEvent(dayEventsData *data, String summary, time_t start, time_t end) {
-  if (data->eventCount >= MAX_DAY_EVENTS) {
-    return;
+void copySummary(char *dst, const char *summary) {
+  strncpy(dst, summary, MAX_EVENT_NAME_LEN - 1);
+  dst[MAX_EVENT_NAME_LEN - 1] = 0;
+}
+
+uint8_t listStart(const EventPool *pool, uint8_t list) {
+  return list == 0 ? 0 : pool->listEnd[list - 1];
+}
+
+time_t startAt(const EventPool *pool, uint8_t pos) {
+  return pool->base + (time_t)pool->events[pool->order[pos]].start * 60;
+}
+
+// firstStartingAfter returns the first position from lo up to hi whose event
+// starts after t, or hi.
+uint8_t firstStartingAfter(const EventPool *pool, uint8_t lo, uint8_t hi,
+                           time_t t) {
+  while (lo < hi) {
+    uint8_t mid = lo + (hi - lo) / 2;
+    if (startAt(pool, mid) > t) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+// updateMaxEnd recomputes maxEnd for list from position pos on.
+void updateMaxEnd(EventPool *pool, uint8_t list, uint8_t pos) {
+  uint8_t begin = listStart(pool, list);
+  for (; pos < pool->listEnd[list]; pos++) {
+    const pooledEvent *event = &pool->events[pool->order[pos]];
+    uint32_t end             = (uint32_t)event->start + event->length;
+    if (end > UINT16_MAX) {
+      end = UINT16_MAX;
+    }
+    if (pos > begin && pool->maxEnd[pos - 1] > end) {
+      end = pool->maxEnd[pos - 1];
+    }
+    pool->maxEnd[pos] = end;
+  }
+}
+
+// find sets *offset to where the first len characters of summary are in
+// pool's text, if they're there.
+bool find(const EventPool *pool, const char *summary, size_t len,
+          uint16_t *offset) {
+  for (uint8_t i = 0; i < pool->eventCount; i++) {
+    const char *text = &pool->text[pool->events[i].summary];
+    if (strncmp(text, summary, len) == 0 && text[len] == 0) {
+      *offset = pool->events[i].summary;
+      return true;
+    }
+  }
+  return false;
+}
+
+// intern sets *offset to where summary is in pool's text, adding it if it
+// isn't there yet. it can add at most room bytes, and is cut short to fit.
+bool intern(EventPool *pool, const char *summary, uint16_t room,
+            uint16_t *offset) {
+  size_t len = strnlen(summary, EVENT_POOL_SUMMARY_LEN - 1);
+  if (len == 0) {
+    *offset = 0;
+    return true;
+  }
+  if (find(pool, summary, len, offset)) {
+    return true;
+  }
+  if (len + 1 > room) {
+    if (room <= 1) {
+      return false;
+    }
+    len = room - 1;
+    if (find(pool, summary, len, offset)) {
+      return true;
+    }
   }
-  if (data->eventCount == MAX_DAY_EVENTS - 1) {
-    summary = "TOO MANY EVENTS";
+  *offset = pool->textUsed;
+  memcpy(&pool->text[*offset], summary, len);
+  pool->text[*offset + len] = 0;
+  pool->textUsed += len + 1;
+  return true;
+}
+} // namespace
+
+void reset(EventPool *pool, time_t now) {
+  pool->base = now - EVENT_POOL_PAST_SECONDS;
+  pool->base -= pool->base % 60;
+  pool->eventCount = 0;
+  pool->eventsFull = false;
+  pool->alarmsFull = false;
+  // offset 0 is the empty summary, and TOO_MANY_EVENTS follows it.
+  pool->text[0] = 0;
+  memcpy(&pool->text[TOO_MANY_EVENTS_AT], TOO_MANY_EVENTS,
+         sizeof(TOO_MANY_EVENTS));
+  pool->textUsed = TOO_MANY_EVENTS_AT + sizeof(TOO_MANY_EVENTS);
+  for (uint8_t i = 0; i < EVENT_LISTS; i++) {
+    pool->listEnd[i] = 0;
   }
-  data->events[data->eventCount].start = start;
-  data->events[data->eventCount].end   = end;
-  summary.toCharArray(data->events[data->eventCount].summary,
-                      MAX_EVENT_NAME_LEN);
-  data->eventCount++;
 }
 
-void reset(eventsData *data) { data->eventCount = 0; }
+void addEvent(EventPool *pool, uint8_t list, const char *summary, time_t start,
+              time_t end) {
+  bool alarm = list == EVENT_LIST_ALARMS;
+  if (list >= EVENT_LISTS || (alarm ? pool->alarmsFull : pool->eventsFull)) {
+    return;
+  }
+  // events that started before the base are kept as if they started then.
+  time_t startMinutes = start < pool->base ? 0 : (start - pool->base) / 60;
+  time_t endMinutes   = end < pool->base ? 0 : (end - pool->base) / 60;
+  if (startMinutes > UINT16_MAX) {
+    return;
+  }
+  time_t length = endMinutes - startMinutes;
+  if (length < 0) {
+    length = 0;
+  } else if (length > UINT16_MAX) {
+    length = UINT16_MAX;
+  }
 
-void addEvent(eventsData *data, String summary, time_t start, time_t end) {
-  if (data->eventCount >= MAX_EVENTS_PER_COLUMN) {
+  // alarms can have whatever's left, but the other lists have to leave the
+  // alarms their share of the events, and of the text for the ones not yet
+  // added.
+  uint8_t left   = EVENT_POOL_EVENTS - pool->eventCount;
+  uint16_t limit = EVENT_POOL_TEXT;
+  if (!alarm) {
+    uint8_t alarms = eventCount(pool, EVENT_LIST_ALARMS);
+    uint8_t kept = alarms < EVENT_POOL_ALARMS ? EVENT_POOL_ALARMS - alarms : 0;
+    left         = left > kept ? left - kept : 0;
+    limit -= kept * EVENT_POOL_TEXT_PER_EVENT;
+  }
+  if (left == 0) {
     return;
   }
-  if (data->eventCount == MAX_EVENTS_PER_COLUMN - 1) {
-    summary = "TOO MANY EVENTS";
+  // a summary can be as long as it likes while that leaves each event still
+  // to come its share of the text, and gets cut to its own share after that.
+  uint16_t room   = limit > pool->textUsed ? limit - pool->textUsed : 0;
+  uint16_t others = (left - 1) * EVENT_POOL_TEXT_PER_EVENT;
+  if (room >= others + EVENT_POOL_TEXT_PER_EVENT) {
+    room -= others;
+  } else if (room > EVENT_POOL_TEXT_PER_EVENT) {
+    room = EVENT_POOL_TEXT_PER_EVENT;
   }
-  data->events[data->eventCount].start = start;
-  data->events[data->eventCount].end   = end;
-  summary.toCharArray(data->events[data->eventCount].summary,
-                      MAX_EVENT_NAME_LEN);
-  data->eventCount++;
+  uint16_t offset;
+  if (left == 1 || !intern(pool, summary, room, &offset)) {
+    offset = TOO_MANY_EVENTS_AT;
+    if (alarm) {
+      pool->alarmsFull = true;
+    } else {
+      pool->eventsFull = true;
+    }
+  }
+
+  pooledEvent *event = &pool->events[pool->eventCount];
+  event->start       = startMinutes;
+  event->length      = length;
+  event->summary     = offset;
+  event->early       = start < pool->base;
+
+  // the server sends events in order, so the place for this one is nearly
+  // always the end of its list. the lists after it move up one to make room.
+  uint8_t begin = listStart(pool, list);
+  uint8_t at    = pool->listEnd[list];
+  while (at > begin && pool->events[pool->order[at - 1]].start > event->start) {
+    at--;
+  }
+  memmove(&pool->order[at + 1], &pool->order[at], pool->eventCount - at);
+  memmove(&pool->maxEnd[at + 1], &pool->maxEnd[at],
+          (pool->eventCount - at) * sizeof(pool->maxEnd[0]));
+  pool->order[at] = pool->eventCount;
+  for (uint8_t i = list; i < EVENT_LISTS; i++) {
+    pool->listEnd[i]++;
+  }
+  pool->eventCount++;
+  updateMaxEnd(pool, list, at);
+}
+
+void addAlarm(EventPool *pool, const char *summary, time_t start) {
+  addEvent(pool, EVENT_LIST_ALARMS, summary, start, start);
+}
+
+uint8_t eventCount(const EventPool *pool, uint8_t list) {
+  return pool->listEnd[list] - listStart(pool, list);
+}
+
+eventData event(const EventPool *pool, uint8_t list, uint8_t i) {
+  const pooledEvent *packed =
+      &pool->events[pool->order[listStart(pool, list) + i]];
+  eventData event;
+  event.summary        = &pool->text[packed->summary];
+  event.start          = pool->base + (time_t)packed->start * 60;
+  event.end            = event.start + (time_t)packed->length * 60;
+  event.startedEarlier = packed->early;
+  return event;
+}
+
+void eventsOverlapping(const EventPool *pool, uint8_t list, time_t from,
+                       time_t until, uint8_t *first, uint8_t *last) {
+  uint8_t begin = listStart(pool, list);
+  uint8_t end   = pool->listEnd[list];
+  uint8_t lo = begin, hi = end;
+  while (lo < hi) {
+    uint8_t mid = lo + (hi - lo) / 2;
+    if (pool->base + (time_t)pool->maxEnd[mid] * 60 > from) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  *first = lo - begin;
+  *last  = firstStartingAfter(pool, lo, end, until - 1) - begin;
+}
+
+void eventsStarting(const EventPool *pool, uint8_t list, time_t from,
+                    time_t until, uint8_t *first, uint8_t *last) {
+  uint8_t begin = listStart(pool, list);
+  uint8_t end   = pool->listEnd[list];
+  uint8_t lo    = firstStartingAfter(pool, begin, end, from - 1);
+  *first        = lo - begin;
+  *last         = firstStartingAfter(pool, lo, end, until) - begin;
 }
 
 void reset(alarmsData *data) { data->alarmCount = 0; }
 
-void addAlarm(alarmsData *data, String summary, time_t start) {
+void addAlarm(alarmsData *data, const char *summary, time_t start) {
   if (data->alarmCount >= MAX_ALARMS) {
     return;
   }
@@ -54,8 +252,7 @@ void addAlarm(alarmsData *data, String summary, time_t start) {
     summary = "TOO MANY ALARMS";
   }
   data->alarms[data->alarmCount].start = start;
-  summary.toCharArray(data->alarms[data->alarmCount].summary,
-                      MAX_EVENT_NAME_LEN);
+  copySummary(data->alarms[data->alarmCount].summary, summary);
   data->alarmCount++;
 }
 
@@ -71,16 +268,19 @@ void CalendarDayEvents::maybeDraw(Display *display, int16_t x0, int16_t y0,
 
   time_t drawnTimeUnix = watchy_->unixtime() + offset_;
 
-  for (int i = 0; i < data_->eventCount; i++) {
-    String text = data_->events[i].summary;
-    if (data_->events[i].start > drawnTimeUnix ||
-        data_->events[i].end <= drawnTimeUnix) {
+  uint8_t first, last;
+  eventsOverlapping(data_, EVENT_LIST_DAY, drawnTimeUnix, drawnTimeUnix + 1,
+                    &first, &last);
+  for (uint8_t i = first; i < last; i++) {
+    eventData event = ::event(data_, EVENT_LIST_DAY, i);
+    if (event.end <= drawnTimeUnix) {
       continue;
     }
+    String text = event.summary;
 
     uint16_t textWidth, textHeight;
     int16_t x1, y1;
-    display->getTextBounds(text, 0, 0, &x1, &y1, &textWidth, &textHeight);
+    textBounds(display, SMALL_FONT, text, &x1, &y1, &textWidth, &textHeight);
     textWidth += EVENT_PADDING * 2;
     textHeight += EVENT_PADDING;
     if (textWidth > *width) {
@@ -110,30 +310,33 @@ void CalendarMonth::draw(Display *display, int16_t x0, int16_t y0,
 
   String lastDayStr = "";
 
-  for (int i = offset_; i < data_->eventCount; i++) {
-    eventData *event = &(data_->events[i]);
+  for (int i = offset_; i < eventCount(data_, EVENT_LIST_DAY); i++) {
+    eventData event = ::event(data_, EVENT_LIST_DAY, i);
 
-    tmElements_t start = watchy_->toLocalTime(event->start);
+    tmElements_t start = watchy_->toLocalTime(event.start);
     String str         = String(dayShortStr(start.Wday)).substring(0, 2);
+    // an event that started before the pool's base only has the base as its
+    // start, so it's shown as starting before then, on no particular day.
+    String before = " ";
+    if (event.startedEarlier) {
+      str    = "..";
+      before = "<";
+    }
 
     if (dayDelta_) {
       time_t now = watchy_->unixtime();
-      int days   = (event->start - now + (24 * 60 * 60 - 1)) / (24 * 60 * 60);
+      int days   = (event.start - now + (24 * 60 * 60 - 1)) / (24 * 60 * 60);
       if (days < 10) {
-        str += "  ";
-      } else {
         str += " ";
       }
-      str += String(days) + "d";
+      str += before + String(days) + "d";
     } else {
-      tmElements_t end = watchy_->toLocalTime(event->end);
+      tmElements_t end = watchy_->toLocalTime(event.end);
       if (start.Day < 10) {
-        str += "  ";
-      } else {
         str += " ";
       }
-      str += String(start.Day);
-      if (event->end > event->start + 24 * 60 * 60 + 1) {
+      str += before + String(start.Day);
+      if (event.end > event.start + 24 * 60 * 60 + 1) {
         str += "-" + String(end.Day);
       }
     }
@@ -148,7 +351,7 @@ void CalendarMonth::draw(Display *display, int16_t x0, int16_t y0,
       lastDayStr = str;
     }
 
-    str += String(event->summary);
+    str += String(event.summary);
 
     LayoutText text(str, SMALL_FONT, color_);
     uint16_t w, h;
@@ -157,8 +360,8 @@ void CalendarMonth::draw(Display *display, int16_t x0, int16_t y0,
       break;
     }
 
-    text.draw(display, x0 + EVENT_PADDING, y0 + EVENT_PADDING, targetWidth,
-              targetHeight, &w, &h);
+    text.render(display, x0 + EVENT_PADDING, y0 + EVENT_PADDING,
+                targetWidth, targetHeight, &w, &h);
     targetHeight -= h + EVENT_PADDING;
     y0 += h + EVENT_PADDING;
   }
@@ -182,16 +385,15 @@ void CalendarColumn::draw(Display *display, int16_t x0, int16_t y0,
   time_t windowStart       = windowOffset - CALENDAR_PAST_SECONDS;
   time_t windowEnd         = windowStart + (targetHeight * SECONDS_PER_PIXEL);
 
-  for (int i = 0; i < data_->eventCount; i++) {
-    eventData *event  = &(data_->events[i]);
-    time_t eventStart = event->start;
-    time_t eventEnd   = event->end;
+  uint8_t first, last;
+  eventsOverlapping(data_, column_, windowStart, windowEnd, &first, &last);
+  for (uint8_t i = first; i < last; i++) {
+    eventData event   = ::event(data_, column_, i);
+    time_t eventStart = event.start;
+    time_t eventEnd   = event.end;
     if (eventEnd <= windowStart) {
       continue;
     }
-    if (eventStart >= windowEnd) {
-      break;
-    }
 
     if (eventEnd - eventStart < SMALLEST_EVENT) {
       eventEnd = eventStart + SMALLEST_EVENT;
@@ -219,12 +421,17 @@ void CalendarColumn::draw(Display *display, int16_t x0, int16_t y0,
     if (targetWidth <= EVENT_PADDING * 2 || eventSize <= EVENT_PADDING * 2) {
       continue;
     }
+    // the summary may be shared with other events, so it's cut to fit in a
+    // copy.
+    char summary[EVENT_POOL_SUMMARY_LEN];
+    strncpy(summary, event.summary, sizeof(summary) - 1);
+    summary[sizeof(summary) - 1] = 0;
     int16_t x1, y1;
     uint16_t tw, th;
-    display->getTextBounds(event->summary, 0, 0, &x1, &y1, &tw, &th);
+    textBounds(display, SMALL_FONT, summary, &x1, &y1, &tw, &th);
     if (tw + (EVENT_PADDING * 2) > targetWidth ||
         th + (EVENT_PADDING * 2) > eventSize) {
-      resizeText(display, event->summary, MAX_EVENT_NAME_LEN,
+      resizeText(display, SMALL_FONT, summary, sizeof(summary),
                  targetWidth - (EVENT_PADDING * 2),
                  eventSize - (EVENT_PADDING * 2), &x1, &y1, &tw, &th);
     }
@@ -232,24 +439,19 @@ void CalendarColumn::draw(Display *display, int16_t x0, int16_t y0,
     if (th + (EVENT_PADDING * 2) <= eventSize) {
       display->setCursor(x0 - x1 + EVENT_PADDING,
                          y0 - y1 + eventOffset + EVENT_PADDING);
-      display->print(event->summary);
+      display->print(summary);
     }
   }
 }
 
-bool CalendarColumn::shouldVibrateOnEventStart(Watchy *watchy,
-                                               eventsData *data) {
+bool CalendarColumn::shouldVibrateOnEventStart(Watchy *watchy, EventPool *data,
+                                               uint8_t column) {
   time_t tooOld = watchy->unixtime() - 60;
   time_t tooNew = tooOld + 120;
-  for (int i = 0; i < data->eventCount; i++) {
-    eventData *event  = &(data->events[i]);
-    time_t eventStart = event->start;
-    if (eventStart < tooOld) {
-      continue;
-    }
-    if (eventStart > tooNew) {
-      break;
-    }
+  uint8_t first, last;
+  eventsStarting(data, column, tooOld, tooNew, &first, &last);
+  for (uint8_t i = first; i < last; i++) {
+    time_t eventStart = event(data, column, i).start;
     tmElements_t currentTime  = watchy->localtime();
     tmElements_t eventStarttm = watchy->toLocalTime(eventStart);
     if (eventStarttm.Minute == currentTime.Minute) {
@@ -259,18 +461,14 @@ bool CalendarColumn::shouldVibrateOnEventStart(Watchy *watchy,
   return false;
 }
 
-void CalendarColumn::resizeText(Display *display, char *text, uint8_t buflen,
-                                uint16_t width, uint16_t height, int16_t *x1,
-                                int16_t *y1, uint16_t *tw, uint16_t *th) {
-  String original = text;
-  String result;
-  int i = 0;
-  while (true) {
-    if (i >= original.length()) {
-      break;
-    }
-    display->getTextBounds(result + original[i], 0, 0, x1, y1, tw, th);
-    if (*tw > width) {
+void CalendarColumn::resizeText(Display *display, const GFXfont *font,
+                                char *text, uint8_t buflen, uint16_t width,
+                                uint16_t height, int16_t *x1, int16_t *y1,
+                                uint16_t *tw, uint16_t *th) {
+  TextRun run(font);
+  uint8_t i = 0;
+  while (i + 1 < buflen && text[i]) {
+    if (run.add(text[i]) > width) {
       // TODO: newlines aren't handled by the display library
       // in a way where the x offset is reset to the offset of
       // the previous line. instead, the x offset is reset to
@@ -281,11 +479,10 @@ void CalendarColumn::resizeText(Display *display, char *text, uint8_t buflen,
       // subsequent lines.
       break;
     }
-    result += original[i];
     i++;
   }
-  result.toCharArray(text, buflen);
-  display->getTextBounds(result, 0, 0, x1, y1, tw, th);
+  text[i] = 0;
+  textBounds(display, font, text, x1, y1, tw, th);
 }
 
 void CalendarHourBar::maybeDraw(Display *display, int16_t x0, int16_t y0,
@@ -327,7 +524,7 @@ void CalendarHourBar::maybeDraw(Display *display, int16_t x0, int16_t y0,
     text += hourNum;
     int16_t x1, y1;
     uint16_t tw, th;
-    display->getTextBounds(text, 0, 0, &x1, &y1, &tw, &th);
+    textBounds(display, SMALL_FONT, text, &x1, &y1, &tw, &th);
     if ((th + 3) * SECONDS_PER_PIXEL + hourTime > windowEnd) {
       continue;
     }
@@ -376,15 +573,12 @@ void CalendarAlarms::maybeDraw(Display *display, int16_t x0, int16_t y0,
   time_t now         = watchy_->unixtime();
   time_t windowStart = now - (2 * 60);
   time_t windowEnd   = now + (60 * 60);
-  for (int i = 0; i < data_->alarmCount; i++) {
-    alarmData *alarm = &(data_->alarms[i]);
-    if (alarm->start < windowStart) {
-      continue;
-    }
-    if (alarm->start > windowEnd) {
-      break;
-    }
-    tmElements_t alarmtm = watchy_->toLocalTime(alarm->start);
+  uint8_t first, last;
+  eventsStarting(data_, EVENT_LIST_ALARMS, windowStart, windowEnd, &first,
+                 &last);
+  for (uint8_t i = first; i < last; i++) {
+    eventData alarm = event(data_, EVENT_LIST_ALARMS, i);
+    tmElements_t alarmtm = watchy_->toLocalTime(alarm.start);
     String text;
     int hourNum = ((alarmtm.Hour + 11) % 12) + 1;
     if (hourNum < 10) {
@@ -394,11 +588,11 @@ void CalendarAlarms::maybeDraw(Display *display, int16_t x0, int16_t y0,
     text += (alarmtm.Minute < 10 ? ":0" : ":");
     text += alarmtm.Minute;
     text += ": ";
-    text += alarm->summary;
+    text += alarm.summary;
 
     int16_t x1, y1;
     uint16_t tw, th;
-    display->getTextBounds(text, 0, 0, &x1, &y1, &tw, &th);
+    textBounds(display, NULL, text, &x1, &y1, &tw, &th);
 
     if (!noop) {
       display->setCursor(x0 - x1 + EVENT_PADDING,
@@ -413,26 +607,23 @@ void CalendarAlarms::maybeDraw(Display *display, int16_t x0, int16_t y0,
   }
 }
 
-bool CalendarAlarms::shouldVibrateOnEventStart(Watchy *watchy, alarmsData *data,
+bool CalendarAlarms::shouldVibrateOnEventStart(Watchy *watchy, EventPool *data,
                                                AlertsApp *alerts) {
   time_t now         = watchy->unixtime();
   time_t windowStart = now - 60;
   time_t windowEnd   = now + 60;
   bool found         = false;
-  for (int i = 0; i < data->alarmCount; i++) {
-    alarmData *alarm = &(data->alarms[i]);
-    if (alarm->start < windowStart) {
-      continue;
-    }
-    if (alarm->start > windowEnd) {
-      break;
-    }
+  uint8_t first, last;
+  eventsStarting(data, EVENT_LIST_ALARMS, windowStart, windowEnd, &first,
+                 &last);
+  for (uint8_t i = first; i < last; i++) {
+    eventData alarm = event(data, EVENT_LIST_ALARMS, i);
     tmElements_t currentTime = watchy->localtime();
-    tmElements_t alarmtm     = watchy->toLocalTime(alarm->start);
+    tmElements_t alarmtm     = watchy->toLocalTime(alarm.start);
     if (alarmtm.Minute == currentTime.Minute &&
         alarmtm.Hour == currentTime.Hour) {
       if (alerts != NULL) {
-        alerts->addAlert(alarm->summary, alarm->start);
+        alerts->addAlert(alarm.summary, alarm.start);
       }
       found = true;
     }
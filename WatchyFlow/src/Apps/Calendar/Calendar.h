@@ -4,26 +4,100 @@
 
 class AlertsApp;
 
-const uint8_t MAX_EVENT_NAME_LEN    = 24;
-const uint8_t MAX_EVENTS_PER_COLUMN = 24;
-const uint8_t MAX_ALARMS            = 24;
-const uint8_t MAX_DAY_EVENTS        = 31;
-
+const uint8_t MAX_CALENDAR_COLUMNS = 6;
+
+// the lists of an EventPool. lists 0 through MAX_CALENDAR_COLUMNS - 1 are the
+// calendar columns.
+const uint8_t EVENT_LIST_DAY    = MAX_CALENDAR_COLUMNS;
+const uint8_t EVENT_LIST_ALARMS = MAX_CALENDAR_COLUMNS + 1;
+const uint8_t EVENT_LISTS       = MAX_CALENDAR_COLUMNS + 2;
+
+const uint8_t EVENT_POOL_EVENTS = 160;
+// this many of the events are kept for alarms, which come after the columns.
+const uint8_t EVENT_POOL_ALARMS = 24;
+// summaries can always have this much of the text each, counting the 0 at
+// the end. they can be up to EVENT_POOL_SUMMARY_LEN - 1 long while others
+// leave room.
+const uint16_t EVENT_POOL_TEXT_PER_EVENT = 24;
+// the text also holds the empty summary and "TOO MANY EVENTS".
+const uint16_t EVENT_POOL_TEXT = EVENT_POOL_EVENTS * EVENT_POOL_TEXT_PER_EVENT +
+                                 1 + sizeof("TOO MANY EVENTS");
+const uint8_t EVENT_POOL_SUMMARY_LEN = 64;
+// event times are kept in minutes after the pool's base time, which is this
+// long before the pool was filled, so an event can start up to about 38 days
+// later. events that started before the base are kept as if they started at
+// it, and marked as having started earlier.
+const time_t EVENT_POOL_PAST_SECONDS = 7 * 24 * 60 * 60;
+
+// pooledEvent is how an event is packed into an EventPool.
+typedef struct __attribute__((packed)) pooledEvent {
+  uint16_t start;        // minutes after the pool's base
+  uint16_t length;       // minutes
+  uint16_t summary : 15; // offset into the pool's text
+  uint16_t early : 1;    // started before the pool's base
+} pooledEvent;
+
+// EventPool holds every list of events the calendar keeps in RTC memory, so
+// that any list can use as much of it as the others leave free. Summaries are
+// kept once each in a shared text heap, so repeating events don't take any
+// more room for theirs.
+//
+// Once there's no room left for an event or its summary, the last one that
+// fits is called "TOO MANY EVENTS" instead, and nothing more is added, either
+// to the alarms or to the other lists, whichever ran out.
+typedef struct EventPool {
+  time_t base;
+  uint8_t eventCount;
+  uint16_t textUsed;
+  bool eventsFull;
+  bool alarmsFull;
+  // list i is order[listEnd[i - 1]] through order[listEnd[i] - 1], sorted by
+  // start time, and events starting together are in the order they were
+  // added.
+  uint8_t listEnd[EVENT_LISTS];
+  uint8_t order[EVENT_POOL_EVENTS];
+  // maxEnd[i] is the latest end, in minutes after base, of the events in
+  // order[i]'s list up to and including it. since it never goes down along a
+  // list, the first event that could still be going on at some time can be
+  // found with a binary search, just like the first to start after it.
+  uint16_t maxEnd[EVENT_POOL_EVENTS];
+  pooledEvent events[EVENT_POOL_EVENTS];
+  char text[EVENT_POOL_TEXT];
+} EventPool;
+
+// eventData is an event unpacked from an EventPool.
 typedef struct eventData {
-  char summary[MAX_EVENT_NAME_LEN];
+  const char *summary;
   time_t start;
   time_t end;
+  // the event really started before start, which is the pool's base.
+  bool startedEarlier;
 } eventData;
 
-typedef struct dayEventsData {
-  eventData events[MAX_DAY_EVENTS];
-  uint8_t eventCount;
-} dayEventsData;
-
-typedef struct eventsData {
-  eventData events[MAX_EVENTS_PER_COLUMN];
-  uint8_t eventCount;
-} eventsData;
+// reset empties pool for events that start from about now on.
+void reset(EventPool *pool, time_t now);
+// summaries longer than EVENT_POOL_SUMMARY_LEN - 1 are cut short, and times
+// are rounded down to the minute. alarms are events in EVENT_LIST_ALARMS that
+// end when they start.
+void addEvent(EventPool *pool, uint8_t list, const char *summary, time_t start,
+              time_t end);
+void addAlarm(EventPool *pool, const char *summary, time_t start);
+uint8_t eventCount(const EventPool *pool, uint8_t list);
+eventData event(const EventPool *pool, uint8_t list, uint8_t i);
+// eventsOverlapping sets events *first up to *last of list to those that
+// might be going on at some point from from until until. every event after
+// them starts at or after until, and every one before them ends by from, but
+// some in between can still have ended by from.
+void eventsOverlapping(const EventPool *pool, uint8_t list, time_t from,
+                       time_t until, uint8_t *first, uint8_t *last);
+// eventsStarting sets events *first up to *last of list to exactly those that
+// start from from through until.
+void eventsStarting(const EventPool *pool, uint8_t list, time_t from,
+                    time_t until, uint8_t *first, uint8_t *last);
+
+// alarmsData holds the alerts AlertsApp has yet to show.
+const uint8_t MAX_EVENT_NAME_LEN = 24;
+const uint8_t MAX_ALARMS         = 24;
 
 typedef struct alarmData {
   char summary[MAX_EVENT_NAME_LEN];
@@ -35,16 +109,13 @@ typedef struct alarmsData {
   uint8_t alarmCount;
 } alarmsData;
 
-void reset(dayEventsData *data);
-void reset(eventsData *data);
 void reset(alarmsData *data);
-void addEvent(dayEventsData *data, String summary, time_t start, time_t end);
-void addEvent(eventsData *data, String summary, time_t start, time_t end);
-void addAlarm(alarmsData *data, String summary, time_t start);
+// summaries longer than MAX_EVENT_NAME_LEN - 1 are cut short.
+void addAlarm(alarmsData *data, const char *summary, time_t start);
 
 class CalendarDayEvents : public LayoutElement {
 public:
-  CalendarDayEvents(dayEventsData *data, Watchy *watchy, int32_t offsetSeconds,
+  CalendarDayEvents(EventPool *data, Watchy *watchy, int32_t offsetSeconds,
                     uint16_t color)
       : data_(data), watchy_(watchy), offset_(offsetSeconds), color_(color) {}
   CalendarDayEvents(const CalendarDayEvents &copy)
@@ -62,7 +133,7 @@ public:
   }
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<CalendarDayEvents>(*this);
+    return LayoutElement::ptr(new CalendarDayEvents(*this));
   }
 
 private:
@@ -71,7 +142,7 @@ private:
                  bool noop);
 
 private:
-  dayEventsData *data_;
+  EventPool *data_;
   Watchy *watchy_;
   int32_t offset_;
   uint16_t color_;
@@ -79,7 +150,7 @@ private:
 
 class CalendarMonth : public LayoutElement {
 public:
-  CalendarMonth(dayEventsData *data, Watchy *watchy, int32_t offsetEvents,
+  CalendarMonth(EventPool *data, Watchy *watchy, int32_t offsetEvents,
                 bool dayDelta, uint16_t color)
       : data_(data), watchy_(watchy), offset_(offsetEvents),
         dayDelta_(dayDelta), color_(color) {}
@@ -97,11 +168,11 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<CalendarMonth>(*this);
+    return LayoutElement::ptr(new CalendarMonth(*this));
   }
 
 private:
-  dayEventsData *data_;
+  EventPool *data_;
   Watchy *watchy_;
   int32_t offset_;
   bool dayDelta_;
@@ -110,12 +181,13 @@ private:
 
 class CalendarColumn : public LayoutElement {
 public:
-  CalendarColumn(eventsData *data, Watchy *watchy, int32_t offsetSeconds,
-                 uint16_t color)
-      : data_(data), watchy_(watchy), offset_(offsetSeconds), color_(color) {}
+  CalendarColumn(EventPool *data, uint8_t column, Watchy *watchy,
+                 int32_t offsetSeconds, uint16_t color)
+      : data_(data), column_(column), watchy_(watchy), offset_(offsetSeconds),
+        color_(color) {}
   CalendarColumn(const CalendarColumn &copy)
-      : data_(copy.data_), watchy_(copy.watchy_), offset_(copy.offset_),
-        color_(copy.color_) {}
+      : data_(copy.data_), column_(copy.column_), watchy_(copy.watchy_),
+        offset_(copy.offset_), color_(copy.color_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override {
@@ -127,18 +199,20 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<CalendarColumn>(*this);
+    return LayoutElement::ptr(new CalendarColumn(*this));
   }
 
-  static bool shouldVibrateOnEventStart(Watchy *watchy, eventsData *data);
+  static bool shouldVibrateOnEventStart(Watchy *watchy, EventPool *data,
+                                        uint8_t column);
 
 private:
-  void resizeText(Display *display, char *text, uint8_t buflen, uint16_t width,
-                  uint16_t height, int16_t *x1, int16_t *y1, uint16_t *tw,
-                  uint16_t *th);
+  void resizeText(Display *display, const GFXfont *font, char *text,
+                  uint8_t buflen, uint16_t width, uint16_t height, int16_t *x1,
+                  int16_t *y1, uint16_t *tw, uint16_t *th);
 
 private:
-  eventsData *data_;
+  EventPool *data_;
+  uint8_t column_;
   Watchy *watchy_;
   int32_t offset_;
   uint16_t color_;
@@ -161,7 +235,7 @@ public:
   }
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<CalendarHourBar>(*this);
+    return LayoutElement::ptr(new CalendarHourBar(*this));
   }
 
 private:
@@ -177,7 +251,7 @@ private:
 
 class CalendarAlarms : public LayoutElement {
 public:
-  CalendarAlarms(alarmsData *data, Watchy *watchy, uint16_t color)
+  CalendarAlarms(EventPool *data, Watchy *watchy, uint16_t color)
       : data_(data), watchy_(watchy), color_(color) {}
   CalendarAlarms(const CalendarAlarms &copy)
       : data_(copy.data_), watchy_(copy.watchy_), color_(copy.color_) {}
@@ -192,10 +266,10 @@ public:
   }
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<CalendarAlarms>(*this);
+    return LayoutElement::ptr(new CalendarAlarms(*this));
   }
 
-  static bool shouldVibrateOnEventStart(Watchy *watchy, alarmsData *data,
+  static bool shouldVibrateOnEventStart(Watchy *watchy, EventPool *data,
                                         AlertsApp *alerts);
 
 private:
@@ -204,7 +278,7 @@ private:
                  bool noop);
 
 private:
-  alarmsData *data_;
+  EventPool *data_;
   Watchy *watchy_;
   uint16_t color_;
 };
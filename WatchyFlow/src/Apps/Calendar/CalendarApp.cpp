@@ -1,9 +1,11 @@
 #include "CalendarApp.h"
 
-#include <HTTPClient.h>
 #include <Arduino_JSON.h>
 #include <Fonts/Picopixel.h>
 #include "../../Layout/Layout.h"
+#include "../../Net/HTTPPool.h"
+#include "../../Net/JsonStream.h"
+#include "../../Net/Parallel.h"
 #include "../../Elements/Battery.h"
 #include "Calendar.h"
 #include "../../Elements/Weather.h"
@@ -12,16 +14,20 @@
 #include "../../Fonts/DSEG7_Classic_Regular_39.h"
 #include "icons.h"
 
-const uint8_t MAX_CALENDAR_COLUMNS                 = 6;
 const uint16_t MAX_SECONDS_BETWEEN_WEATHER_UPDATES = 60 * 60 * 2;
 const int32_t DAY_SCROLL_INCREMENT                 = 3 * 30 * 60;
 
 namespace {
-RTC_DATA_ATTR dayEventsData calendarDay;
-RTC_DATA_ATTR eventsData calendar[MAX_CALENDAR_COLUMNS];
-RTC_DATA_ATTR alarmsData alarms;
+RTC_DATA_ATTR EventPool eventPool;
 RTC_DATA_ATTR uint8_t activeCalendarColumns;
 RTC_DATA_ATTR char calendarError[32];
+// the ETag of the calendar response the RTC calendar data came from, to ask
+// the server for the calendar only if it changed.
+RTC_DATA_ATTR char calendarETag[20];
+// whether the calendar server sent the weather and air quality along with the
+// calendar last time, so they needn't be asked for separately.
+RTC_DATA_ATTR bool weatherFromServer;
+RTC_DATA_ATTR bool airQualityFromServer;
 RTC_DATA_ATTR uint16_t lastTemperature;
 RTC_DATA_ATTR int16_t weatherConditionCode;
 RTC_DATA_ATTR float airQualityPM25;
@@ -41,9 +47,7 @@ void zeroError() {
 
 void CalendarApp::reset(Watchy *watchy) {
   activeCalendarColumns = 1;
-  ::reset(&calendar[0]);
-  ::reset(&alarms);
-  ::reset(&calendarDay);
+  ::reset(&eventPool, watchy->unixtime());
   lastTemperature       = 0;
   weatherConditionCode  = -1;
   airQualityPM25        = -1;
@@ -53,165 +57,574 @@ void CalendarApp::reset(Watchy *watchy) {
   monthDayAbs           = false;
   monthEventOffset      = 0;
   zeroError();
+  calendarETag[0]      = 0;
+  weatherFromServer    = false;
+  airQualityFromServer = false;
   setActiveLocation(0);
 }
 
 void CalendarApp::setActiveLocation(int location) { activeLocation = location; }
 
-FetchState CalendarApp::fetchNetwork(Watchy *watchy) {
-  FetchState fetchState = FETCH_OK;
-  time_t timezoneOffset = watchy->timezoneOffset();
-
-  {
-    HTTPClient http;
-    http.setConnectTimeout(1000 * 30);
-    http.setTimeout(1000 * 30);
-    String weatherQueryURL = settings_.locations[activeLocation].weatherURL;
-    http.begin(weatherQueryURL.c_str());
-    if (http.GET() == 200) {
-      String payload         = http.getString();
-      JSONVar responseObject = JSON.parse(payload);
-      lastTemperature        = int(responseObject["main"]["temp"]);
-      weatherConditionCode   = int(responseObject["weather"][0]["id"]);
-      timezoneOffset         = int(responseObject["timezone"]);
-      watchy->setTimezoneOffset(timezoneOffset);
+namespace {
+// all of a network fetch's requests have to finish within this long.
+const uint32_t FETCH_DEADLINE_MS = 1000 * 30;
+
+// timeoutUntil is how long a request may wait on the network and still give
+// up by deadline.
+uint16_t timeoutUntil(uint32_t deadline) {
+  int32_t left = (int32_t)(deadline - millis());
+  if (left <= 0) {
+    return 1;
+  }
+  return left > UINT16_MAX ? UINT16_MAX : left;
+}
+
+void setDeadline(PooledHTTP &http, uint32_t deadline) {
+  http->setConnectTimeout(timeoutUntil(deadline));
+  http->setTimeout(timeoutUntil(deadline));
+}
+
+String urlEncode(const String &value) {
+  const char *hex = "0123456789ABCDEF";
+  String encoded;
+  for (unsigned int i = 0; i < value.length(); i++) {
+    char c = value[i];
+    if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+      encoded += c;
     } else {
-      fetchState = FETCH_TRYAGAIN;
+      encoded += '%';
+      encoded += hex[(uint8_t)c >> 4];
+      encoded += hex[(uint8_t)c & 0xF];
     }
-    http.end();
   }
+  return encoded;
+}
+} // namespace
 
-  {
-    String weatherQueryURL = settings_.locations[activeLocation].airQualityURL;
-    if (weatherQueryURL.length() == 0) {
-      airQualityPM25 = -1;
-    } else {
-      HTTPClient http;
-      http.setConnectTimeout(1000 * 30);
-      http.setTimeout(1000 * 30);
-      http.begin(weatherQueryURL.c_str());
-      if (http.GET() == 200) {
-        airQualityPM25         = -1;
-        String payload         = http.getString();
-        JSONVar responseObject = JSON.parse(payload);
-        if (responseObject.hasOwnProperty("sensor")) {
-          auto sensor = responseObject["sensor"];
-          if (sensor.hasOwnProperty("stats")) {
-            auto stats = sensor["stats"];
-            if (stats.hasOwnProperty("pm2.5_30minute")) {
-              airQualityPM25 =
-                  float(static_cast<double>(stats["pm2.5_30minute"]));
-            }
-          }
+// CalendarFetch is what the requests of one network fetch share. Each
+// request, running in parallel with the others, only writes its own results.
+typedef struct CalendarFetch {
+  CalendarApp *app;
+  HTTPPool *pool;
+  time_t now;
+  uint32_t deadline;
+  String calendarURL;
+  bool calendarOK;
+  bool weatherOK;
+  bool airQualityOK;
+  time_t timezoneOffset;
+
+  // what the calendar request found out.
+  bool notModified;
+  bool serverWeather;
+  int16_t serverTemperature;
+  int16_t serverConditionCode;
+  int32_t serverTimezoneOffset;
+  bool serverAirQuality;
+  float serverPM25;
+} CalendarFetch;
+
+FetchState CalendarApp::fetchNetwork(Watchy *watchy) {
+  CalendarFetch fetch;
+  fetch.app              = this;
+  fetch.pool             = &watchy->http();
+  fetch.now              = watchy->unixtime();
+  fetch.deadline         = millis() + FETCH_DEADLINE_MS;
+  fetch.calendarOK       = false;
+  fetch.weatherOK        = false;
+  fetch.airQualityOK     = false;
+  fetch.timezoneOffset   = watchy->timezoneOffset();
+  fetch.notModified      = false;
+  fetch.serverWeather    = false;
+  fetch.serverAirQuality = false;
+
+  // the calendar is asked for in the time zone the watch already has, rather
+  // than waiting for the weather to say what it is.
+  fetch.calendarURL = settings_.calendarAccountURL;
+  fetch.calendarURL += "?tz=";
+  fetch.calendarURL += int(fetch.timezoneOffset);
+  fetch.calendarURL += "&steps=";
+  fetch.calendarURL += watchy->totalStepCounter();
+  fetch.calendarURL += "&format=bin&location=";
+  fetch.calendarURL += urlEncode(settings_.locations[activeLocation].name);
+  if (forceCacheMiss_) {
+    fetch.calendarURL += "&force_cache_miss=true";
+  }
+
+  auto calendar = [](void *arg) {
+    CalendarFetch *fetch = static_cast<CalendarFetch *>(arg);
+    fetch->calendarOK    = fetch->app->fetchCalendar(fetch);
+  };
+  auto weather = [](void *arg) {
+    CalendarFetch *fetch = static_cast<CalendarFetch *>(arg);
+    fetch->weatherOK     = fetch->app->fetchWeather(fetch);
+  };
+  auto airQuality = [](void *arg) {
+    CalendarFetch *fetch = static_cast<CalendarFetch *>(arg);
+    fetch->airQualityOK  = fetch->app->fetchAirQuality(fetch);
+  };
+  ParallelJob calendarJob   = {calendar, &fetch, 0};
+  ParallelJob weatherJob    = {weather, &fetch, 0};
+  ParallelJob airQualityJob = {airQuality, &fetch, 0};
+
+  // the weather and air quality are only asked for directly if the calendar
+  // server didn't send them last time.
+  bool directWeather    = !weatherFromServer;
+  bool directAirQuality = !airQualityFromServer;
+  ParallelJob jobs[3];
+  uint8_t count = 0;
+  jobs[count++] = calendarJob;
+  if (directWeather) {
+    jobs[count++] = weatherJob;
+  }
+  if (directAirQuality) {
+    jobs[count++] = airQualityJob;
+  }
+  runParallel(jobs, count);
+
+  if (fetch.calendarOK && fetch.notModified) {
+    // whatever the server sent with the calendar didn't change either.
+    fetch.weatherOK    = fetch.weatherOK || !directWeather;
+    fetch.airQualityOK = fetch.airQualityOK || !directAirQuality;
+  } else if (fetch.calendarOK) {
+    weatherFromServer    = fetch.serverWeather;
+    airQualityFromServer = fetch.serverAirQuality;
+    if (fetch.serverWeather) {
+      lastTemperature      = fetch.serverTemperature;
+      weatherConditionCode = fetch.serverConditionCode;
+      fetch.timezoneOffset = fetch.serverTimezoneOffset;
+      fetch.weatherOK      = true;
+    }
+    if (fetch.serverAirQuality) {
+      airQualityPM25     = fetch.serverPM25;
+      fetch.airQualityOK = true;
+    }
+  } else {
+    weatherFromServer    = false;
+    airQualityFromServer = false;
+  }
+
+  // anything the server was expected to send but didn't is asked for now.
+  count = 0;
+  if (!directWeather && !fetch.weatherOK) {
+    jobs[count++] = weatherJob;
+  }
+  if (!directAirQuality && !fetch.airQualityOK) {
+    jobs[count++] = airQualityJob;
+  }
+  if (count > 0) {
+    runParallel(jobs, count);
+  }
+
+  FetchState fetchState = FETCH_OK;
+  if (!fetch.calendarOK || !fetch.weatherOK || !fetch.airQualityOK) {
+    fetchState = FETCH_TRYAGAIN;
+  } else if (fetch.notModified && !directWeather && !directAirQuality) {
+    // the server's 304 covered the weather and air quality too.
+    fetchState = FETCH_NOCHANGE;
+  }
+  if (fetch.weatherOK && fetch.timezoneOffset != watchy->timezoneOffset()) {
+    watchy->setTimezoneOffset(fetch.timezoneOffset);
+    // the calendar was asked for in the old time zone.
+    fetchState = FETCH_TRYAGAIN;
+  }
+  return fetchState;
+}
+
+bool CalendarApp::fetchWeather(CalendarFetch *fetch) {
+  PooledHTTP http(*fetch->pool,
+                  settings_.locations[activeLocation].weatherURL);
+  setDeadline(http, fetch->deadline);
+  bool ok = http->GET() == 200;
+  if (ok) {
+    String payload         = http->getString();
+    JSONVar responseObject = JSON.parse(payload);
+    lastTemperature        = int(responseObject["main"]["temp"]);
+    weatherConditionCode   = int(responseObject["weather"][0]["id"]);
+    fetch->timezoneOffset  = int(responseObject["timezone"]);
+  }
+  return ok;
+}
+
+bool CalendarApp::fetchAirQuality(CalendarFetch *fetch) {
+  String airQualityURL = settings_.locations[activeLocation].airQualityURL;
+  if (airQualityURL.length() == 0) {
+    airQualityPM25 = -1;
+    return true;
+  }
+  PooledHTTP http(*fetch->pool, airQualityURL);
+  setDeadline(http, fetch->deadline);
+  bool ok = http->GET() == 200;
+  if (ok) {
+    airQualityPM25         = -1;
+    String payload         = http->getString();
+    JSONVar responseObject = JSON.parse(payload);
+    if (responseObject.hasOwnProperty("sensor")) {
+      auto sensor = responseObject["sensor"];
+      if (sensor.hasOwnProperty("stats")) {
+        auto stats = sensor["stats"];
+        if (stats.hasOwnProperty("pm2.5_30minute")) {
+          airQualityPM25 = float(static_cast<double>(stats["pm2.5_30minute"]));
         }
-      } else {
-        fetchState = FETCH_TRYAGAIN;
       }
-      http.end();
-    }
-  }
-
-  {
-    HTTPClient http;
-    http.setConnectTimeout(1000 * 30);
-    http.setTimeout(1000 * 30);
-    String calQueryURL = settings_.calendarAccountURL;
-    calQueryURL += "?tz=";
-    calQueryURL += int(timezoneOffset);
-    calQueryURL += "&steps=";
-    calQueryURL += watchy->totalStepCounter();
-    if (forceCacheMiss_) {
-      calQueryURL += "&force_cache_miss=true";
-    }
-    http.begin(calQueryURL.c_str());
-    int httpResponseCode = http.GET();
-    if (httpResponseCode == 200) {
-      zeroError();
-      parseCalendar(watchy, http.getString());
+    }
+  }
+  return ok;
+}
+
+bool CalendarApp::fetchCalendar(CalendarFetch *fetch) {
+  PooledHTTP http(*fetch->pool, fetch->calendarURL);
+  setDeadline(http, fetch->deadline);
+  if (calendarETag[0] && !forceCacheMiss_) {
+    http->addHeader("If-None-Match", calendarETag);
+  }
+  const char *headers[] = {"ETag"};
+  http->collectHeaders(headers, sizeof(headers) / sizeof(headers[0]));
+  int httpResponseCode = http->GET();
+  bool ok              = true;
+  if (httpResponseCode == 304) {
+    // the calendar in RTC memory is still current.
+    zeroError();
+    fetch->notModified = true;
+  } else if (httpResponseCode == 200) {
+    zeroError();
+    if (readCalendar(http->getStreamPtr(), fetch)) {
+      String etag     = http->header("ETag");
+      calendarETag[0] = 0;
+      if (etag.length() < sizeof(calendarETag)) {
+        etag.toCharArray(calendarETag, sizeof(calendarETag));
+      }
     } else {
-      String error(httpResponseCode);
+      String error("bad response");
       error.toCharArray(calendarError,
                         sizeof(calendarError) / sizeof(calendarError[0]));
-      fetchState = FETCH_TRYAGAIN;
+      ok = false;
     }
-    http.end();
+  } else {
+    String error(httpResponseCode);
+    error.toCharArray(calendarError,
+                      sizeof(calendarError) / sizeof(calendarError[0]));
+    ok = false;
   }
+  return ok;
+}
 
-  return fetchState;
+namespace {
+// see encode_events() in watchy_server/main.py for the wire format.
+const uint8_t WIRE_HEADER_SIZE         = 6;
+const uint8_t WIRE_EVENT_SIZE          = 11;
+const uint8_t WIRE_FLAG_DAY            = 0x01;
+const uint8_t WIRE_FLAG_ALARM          = 0x02;
+const uint8_t WIRE_SECTION_WEATHER     = 1;
+const uint8_t WIRE_SECTION_AIR_QUALITY = 2;
+
+bool readFully(Stream *stream, void *buf, size_t len) {
+  return stream->readBytes((uint8_t *)buf, len) == len;
 }
 
-void CalendarApp::parseCalendar(Watchy *watchy, String payload) {
-  JSONVar parsed = JSON.parse(payload);
-  if (!parsed.hasOwnProperty("status")) {
-    return;
+// skipFully reads past len bytes.
+bool skipFully(Stream *stream, size_t len) {
+  char skipped[16];
+  while (len > 0) {
+    size_t n = len < sizeof(skipped) ? len : sizeof(skipped);
+    if (!readFully(stream, skipped, n)) {
+      return false;
+    }
+    len -= n;
   }
-  if (!parsed.hasOwnProperty("columns")) {
-    return;
+  return true;
+}
+
+uint32_t littleEndian32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+uint8_t clampColumns(int columns) {
+  if (columns >= MAX_CALENDAR_COLUMNS) {
+    return MAX_CALENDAR_COLUMNS;
   }
-  if (!parsed.hasOwnProperty("events")) {
-    return;
+  if (columns <= 0) {
+    return 1;
   }
-  String status = parsed["status"];
-  if (status != "ok") {
-    return;
+  return columns;
+}
+
+const char *ALARM_TAG = "[WATCHY ALARM]";
+
+// stripAlarmTag removes ALARM_TAG and the space around it from summary, and
+// returns whether it was there.
+bool stripAlarmTag(char *summary) {
+  char *tag = strstr(summary, ALARM_TAG);
+  if (!tag) {
+    return false;
   }
+  char *rest = tag + strlen(ALARM_TAG);
+  memmove(tag, rest, strlen(rest) + 1);
 
-  activeCalendarColumns = (uint8_t)(int)parsed["columns"];
-  if (activeCalendarColumns >= MAX_CALENDAR_COLUMNS) {
-    activeCalendarColumns = MAX_CALENDAR_COLUMNS;
+  char *start = summary;
+  while (*start == ' ') {
+    start++;
   }
-  if (activeCalendarColumns <= 0) {
-    activeCalendarColumns = 1;
+  size_t len = strlen(start);
+  while (len > 0 && start[len - 1] == ' ') {
+    len--;
   }
-  for (int i = 0; i < activeCalendarColumns; i++) {
-    ::reset(&calendar[i]);
+  memmove(summary, start, len);
+  summary[len] = 0;
+  return true;
+}
+
+// CalendarJSON takes in a calendar response in JSON, as servers without the
+// binary format send it, and adds each event to pool as soon as its object
+// ends. The events array is expected in the top level object, like:
+//
+//   {"status": "ok", "columns": 2, "events": [{"summary": ..., "day": ...,
+//    "start": ..., "end": ..., "column": ...}, ...]}
+class CalendarJSON : public JsonHandler {
+public:
+  CalendarJSON(time_t now, EventPool *pool)
+      : pool_(pool), depth_(0), inEvents_(false), ok_(false), columns_(0) {
+    key_[0] = 0;
+    ::reset(pool_, now);
   }
-  ::reset(&calendarDay);
-  ::reset(&alarms);
 
-  JSONVar events = parsed["events"];
-  for (int i = 0; i < events.length(); i++) {
-    JSONVar event = events[i];
-    if (!event.hasOwnProperty("summary")) {
-      continue;
+  void startObject() override {
+    depth_++;
+    if (inEvents_ && depth_ == 3) {
+      fields_ = 0;
     }
-    if (!event.hasOwnProperty("day")) {
-      continue;
+  }
+
+  void endObject() override {
+    if (inEvents_ && depth_ == 3) {
+      addEvent();
     }
-    if (!event.hasOwnProperty("start")) {
-      continue;
+    depth_--;
+  }
+
+  void startArray() override {
+    depth_++;
+    if (depth_ == 2 && strcmp(key_, "events") == 0) {
+      inEvents_ = true;
     }
-    if (!event.hasOwnProperty("end")) {
-      continue;
+  }
+
+  void endArray() override {
+    if (depth_ == 2) {
+      inEvents_ = false;
     }
+    depth_--;
+  }
 
-    time_t start = (time_t)(long)event["start"];
-    time_t end   = (time_t)(long)event["end"];
+  void key(const char *key) override {
+    strncpy(key_, key, sizeof(key_) - 1);
+    key_[sizeof(key_) - 1] = 0;
+  }
 
-    String summary = event["summary"];
-    bool allDay    = (bool)event["day"];
-    if (allDay) {
-      addEvent(&calendarDay, summary, start, end);
-      continue;
+  void value(JsonType type, const char *value) override {
+    if (depth_ == 1) {
+      if (strcmp(key_, "status") == 0) {
+        ok_ = type == JSON_STRING && strcmp(value, "ok") == 0;
+      } else if (strcmp(key_, "columns") == 0 && type == JSON_NUMBER) {
+        columns_ = atoi(value);
+      }
+      return;
     }
+    if (!inEvents_ || depth_ != 3) {
+      return;
+    }
+    if (strcmp(key_, "summary") == 0 && type == JSON_STRING) {
+      strncpy(summary_, value, sizeof(summary_) - 1);
+      summary_[sizeof(summary_) - 1] = 0;
+      fields_ |= FIELD_SUMMARY;
+    } else if (strcmp(key_, "day") == 0) {
+      day_ = type == JSON_TRUE;
+      fields_ |= FIELD_DAY;
+    } else if (strcmp(key_, "start") == 0 && type == JSON_NUMBER) {
+      start_ = atol(value);
+      fields_ |= FIELD_START;
+    } else if (strcmp(key_, "end") == 0 && type == JSON_NUMBER) {
+      end_ = atol(value);
+      fields_ |= FIELD_END;
+    } else if (strcmp(key_, "column") == 0 && type == JSON_NUMBER) {
+      column_ = atoi(value);
+      fields_ |= FIELD_COLUMN;
+    }
+  }
 
-    if (summary.indexOf(String("[WATCHY ALARM]")) >= 0) {
-      summary.replace(String("[WATCHY ALARM]"), String(""));
-      summary.trim();
-      addAlarm(&alarms, summary, start);
-      continue;
+  // finish checks the response was complete once the parser is done with it,
+  // and sets *columns to the number of columns.
+  bool finish(uint8_t *columns) {
+    if (!ok_ || columns_ == 0) {
+      return false;
+    }
+    *columns = clampColumns(columns_);
+    return true;
+  }
+
+private:
+  static const uint8_t FIELD_SUMMARY = 0x01;
+  static const uint8_t FIELD_DAY     = 0x02;
+  static const uint8_t FIELD_START   = 0x04;
+  static const uint8_t FIELD_END     = 0x08;
+  static const uint8_t FIELD_COLUMN  = 0x10;
+  static const uint8_t FIELDS_NEEDED =
+      FIELD_SUMMARY | FIELD_DAY | FIELD_START | FIELD_END;
+
+  void addEvent() {
+    if ((fields_ & FIELDS_NEEDED) != FIELDS_NEEDED) {
+      return;
+    }
+    if (day_) {
+      ::addEvent(pool_, EVENT_LIST_DAY, summary_, start_, end_);
+      return;
+    }
+    if (stripAlarmTag(summary_)) {
+      addAlarm(pool_, summary_, start_);
+      return;
+    }
+    // the number of columns may not have been seen yet.
+    int columns = columns_ ? clampColumns(columns_) : MAX_CALENDAR_COLUMNS;
+    if (!(fields_ & FIELD_COLUMN) || column_ < 0 || column_ >= columns) {
+      return;
+    }
+    ::addEvent(pool_, column_, summary_, start_, end_);
+  }
+
+  EventPool *pool_;
+  uint8_t depth_;
+  bool inEvents_;
+  bool ok_;
+  int columns_;
+  char key_[16];
+
+  uint8_t fields_;
+  char summary_[JSON_TOKEN_LEN];
+  bool day_;
+  time_t start_;
+  time_t end_;
+  int column_;
+};
+
+// readBinaryCalendar decodes a calendar in the binary format into pool, and
+// the number of columns into *columns, after its first byte, first.
+bool readBinaryCalendar(Stream *stream, uint8_t first, CalendarFetch *fetch,
+                        EventPool *pool, uint8_t *columns) {
+  uint8_t header[WIRE_HEADER_SIZE];
+  header[0] = first;
+  if (!readFully(stream, header + 1, sizeof(header) - 1)) {
+    return false;
+  }
+  if (header[0] != 'W' || header[1] != 'F') {
+    return false;
+  }
+  // version 2 adds sections after the events.
+  uint8_t sections = 0;
+  if (header[2] == 2) {
+    if (!readFully(stream, &sections, 1)) {
+      return false;
+    }
+  } else if (header[2] != 1) {
+    return false;
+  }
+
+  *columns = clampColumns(header[3]);
+  ::reset(pool, fetch->now);
+
+  uint16_t count = header[4] | (header[5] << 8);
+  for (uint16_t i = 0; i < count; i++) {
+    uint8_t event[WIRE_EVENT_SIZE];
+    if (!readFully(stream, event, sizeof(event))) {
+      return false;
+    }
+    time_t start  = littleEndian32(&event[0]);
+    time_t end    = littleEndian32(&event[4]);
+    int8_t column = (int8_t)event[8];
+    uint8_t flags = event[9];
+    uint8_t len   = event[10];
+
+    // the summary is read straight onto the stack, and whatever doesn't fit
+    // in an event is read past.
+    char summary[EVENT_POOL_SUMMARY_LEN];
+    uint8_t kept =
+        len < EVENT_POOL_SUMMARY_LEN ? len : EVENT_POOL_SUMMARY_LEN - 1;
+    if (!readFully(stream, summary, kept)) {
+      return false;
+    }
+    summary[kept] = 0;
+    if (!skipFully(stream, len - kept)) {
+      return false;
     }
 
-    if (!event.hasOwnProperty("column")) {
+    if (flags & WIRE_FLAG_DAY) {
+      addEvent(pool, EVENT_LIST_DAY, summary, start, end);
+      continue;
+    }
+    if (flags & WIRE_FLAG_ALARM) {
+      addAlarm(pool, summary, start);
       continue;
     }
-    int column = (int)event["column"];
-    if (column >= activeCalendarColumns || column < 0) {
+    if (column >= *columns || column < 0) {
       continue;
     }
+    addEvent(pool, column, summary, start, end);
+  }
 
-    addEvent(&calendar[column], summary, start, end);
+  for (uint8_t i = 0; i < sections; i++) {
+    uint8_t section[2];
+    uint8_t data[8];
+    if (!readFully(stream, section, sizeof(section))) {
+      return false;
+    }
+    uint8_t kept = section[1] < sizeof(data) ? section[1] : sizeof(data);
+    if (!readFully(stream, data, kept) ||
+        !skipFully(stream, section[1] - kept)) {
+      return false;
+    }
+    if (section[0] == WIRE_SECTION_WEATHER && kept >= 8) {
+      fetch->serverWeather        = true;
+      fetch->serverTemperature    = (int16_t)(data[0] | (data[1] << 8));
+      fetch->serverConditionCode  = (int16_t)(data[2] | (data[3] << 8));
+      fetch->serverTimezoneOffset = (int32_t)littleEndian32(&data[4]);
+    } else if (section[0] == WIRE_SECTION_AIR_QUALITY && kept >= 2) {
+      fetch->serverAirQuality = true;
+      fetch->serverPM25       = (data[0] | (data[1] << 8)) / 10.0f;
+    }
+  }
+  return true;
+}
+} // namespace
+
+bool CalendarApp::readCalendar(Stream *stream, CalendarFetch *fetch) {
+  uint8_t first;
+  if (!readFully(stream, &first, 1)) {
+    return false;
+  }
+
+  // the calendar is decoded into a copy and only replaces the one in RTC
+  // memory once all of it has arrived, so a response that's cut short leaves
+  // the old one, alarms and all. the copy comes from the heap, since
+  // globalArena isn't safe to use alongside the other fetches.
+  EventPool *pool = static_cast<EventPool *>(malloc(sizeof(EventPool)));
+  if (!pool) {
+    return false;
+  }
+  uint8_t columns;
+  bool ok;
+  if (first == '{') {
+    CalendarJSON handler(fetch->now, pool);
+    JsonStream json(&handler);
+    ok = json.feed('{') && json.read(stream) && handler.finish(&columns);
+  } else {
+    ok = readBinaryCalendar(stream, first, fetch, pool, &columns);
   }
+  if (ok) {
+    memcpy(&eventPool, pool, sizeof(EventPool));
+    activeCalendarColumns = columns;
+  }
+  free(pool);
+  return ok;
 }
 
 String secondsToReadable(time_t val) {
@@ -232,55 +645,111 @@ String secondsToReadable(time_t val) {
 
 void CalendarApp::tick(Watchy *watchy) {
   tmElements_t currentTime = watchy->localtime();
+  addTriggers(watchy);
 
   if (currentTime.Hour == 0 && currentTime.Minute == 0) {
     watchy->resetStepCounter();
   }
 
-  if (CalendarAlarms::shouldVibrateOnEventStart(watchy, &alarms, alerts_)) {
+  if (CalendarAlarms::shouldVibrateOnEventStart(watchy, &eventPool,
+                                                alerts_)) {
     // safe to do twice, even if alerts_ takes care of it. will get debounced.
     watchy->queueVibrate(100, 10);
     return;
   }
 
+  if (inSilenceWindow(currentTime)) {
+    return;
+  }
+
+  for (int i = 0; i < activeCalendarColumns; i++) {
+    if (CalendarColumn::shouldVibrateOnEventStart(watchy, &eventPool, i)) {
+      watchy->queueVibrate(75, 5);
+      return;
+    }
+  }
+}
+
+void CalendarApp::addTriggers(Watchy *watchy) {
+  time_t now = watchy->unixtime();
+  // anything starting this minute is this tick's to handle.
+  time_t next  = now - now % 60 + 60;
+  time_t until = next + 24 * 60 * 60;
+  uint8_t first, last;
+  eventsStarting(&eventPool, EVENT_LIST_ALARMS, next, until, &first, &last);
+  if (first < last) {
+    watchy->addTrigger(event(&eventPool, EVENT_LIST_ALARMS, first).start);
+  }
+  for (int i = 0; i < activeCalendarColumns; i++) {
+    eventsStarting(&eventPool, i, next, until, &first, &last);
+    if (first < last) {
+      watchy->addTrigger(event(&eventPool, i, first).start);
+    }
+  }
+  tmElements_t local = watchy->localtime();
+  watchy->addTrigger(now + 24 * 60 * 60 -
+                     ((local.Hour * 60 + local.Minute) * 60 + local.Second));
+}
+
+bool CalendarApp::inSilenceWindow(const tmElements_t &local) {
   if (settings_.silenceWindowHourEnd < settings_.silenceWindowHourStart) {
     // the silence window starts on one day and ends on the next. we will
     // join with OR.
-    if (settings_.silenceWindowHourStart <= currentTime.Hour ||
-        currentTime.Hour < settings_.silenceWindowHourEnd) {
-      return;
-    }
+    return settings_.silenceWindowHourStart <= local.Hour ||
+           local.Hour < settings_.silenceWindowHourEnd;
   } else if (settings_.silenceWindowHourStart <
              settings_.silenceWindowHourEnd) {
     // the silence window begins and ends on the same day. we will
     // join with AND.
-    if (settings_.silenceWindowHourStart <= currentTime.Hour &&
-        currentTime.Hour < settings_.silenceWindowHourEnd) {
-      return;
-    }
-  } else {
-    // the silence window hours are the same. disabled.
+    return settings_.silenceWindowHourStart <= local.Hour &&
+           local.Hour < settings_.silenceWindowHourEnd;
   }
+  // the silence window hours are the same. disabled.
+  return false;
+}
+
+namespace {
+// this many events starting within FETCH_BUSY_SECONDS make for a busy
+// stretch, worth fetching sooner for in case any of them move.
+const uint8_t FETCH_BUSY_EVENTS  = 3;
+const int32_t FETCH_BUSY_SECONDS = 2 * 60 * 60;
+} // namespace
 
+FetchPace CalendarApp::fetchPace(Watchy *watchy) {
+  if (inSilenceWindow(watchy->localtime())) {
+    return FETCH_PACE_IDLE;
+  }
+  time_t now   = watchy->unixtime();
+  uint8_t busy = 0;
   for (int i = 0; i < activeCalendarColumns; i++) {
-    if (CalendarColumn::shouldVibrateOnEventStart(watchy, &calendar[i])) {
-      watchy->queueVibrate(75, 5);
-      return;
-    }
+    uint8_t first, last;
+    eventsStarting(&eventPool, i, now, now + FETCH_BUSY_SECONDS - 1, &first,
+                   &last);
+    busy += last - first;
   }
+  return busy >= FETCH_BUSY_EVENTS ? FETCH_PACE_SOON : FETCH_PACE_NORMAL;
 }
 
 String calcAQI(float Cp, float Ih, float Il, float BPh, float BPl);
 String aqiConvert(float pm25);
 
+bool sameView(const CalendarViewKey &a, const CalendarViewKey &b) {
+  return a.watchy == b.watchy && a.monthView == b.monthView &&
+         a.showAboveCalendar == b.showAboveCalendar &&
+         a.monthDayAbs == b.monthDayAbs &&
+         a.weatherUpToDate == b.weatherUpToDate &&
+         a.airQuality == b.airQuality &&
+         a.weatherConditionCode == b.weatherConditionCode &&
+         a.columns == b.columns && a.dayScheduleOffset == b.dayScheduleOffset &&
+         a.monthEventOffset == b.monthEventOffset;
+}
+
 AppState CalendarApp::show(Watchy *watchy, Display *display) {
   const uint16_t BACKGROUND_COLOR = watchy->backgroundColor();
   display->fillScreen(BACKGROUND_COLOR);
   display->setTextWrap(false);
   tmElements_t currentTime = watchy->localtime();
 
-  uint16_t color = watchy->foregroundColor();
-
   int displayHour = ((currentTime.Hour + 11) % 12) + 1;
   String timeStr  = String(displayHour) + ":";
   if (currentTime.Minute < 10) {
@@ -322,58 +791,134 @@ AppState CalendarApp::show(Watchy *watchy, Display *display) {
     }
   }
 
-  LayoutCell elemTempOrWiFi;
-  if (weatherUpToDate) {
-    elemTempOrWiFi.set(LayoutText(tempStr, &Seven_Segment10pt7b, color));
-  } else {
-    elemTempOrWiFi.set(LayoutBitmap(wifioff, 26, 18, color));
+  CalendarViewKey view;
+  view.watchy               = watchy;
+  view.monthView            = monthView;
+  view.showAboveCalendar    = viewShowAboveCalendar;
+  view.monthDayAbs          = monthDayAbs;
+  view.weatherUpToDate      = weatherUpToDate;
+  view.airQuality           = airQualityPM25 >= 0 && weatherUpToDate;
+  view.weatherConditionCode = weatherConditionCode;
+  view.columns              = activeCalendarColumns;
+  view.dayScheduleOffset    = dayScheduleOffset;
+  view.monthEventOffset     = monthEventOffset;
+
+  // the layout tree is only rebuilt when the shape of the view changes. most
+  // of the time only the text changes, and LayoutText::setText only makes the
+  // text get measured again if it's actually different.
+  if (!view_ || !sameView(view, viewKey_)) {
+    if (view_) {
+      // the old tree is pinned, so give it back before building the new one
+      // in its place, instead of on top of it.
+      view_ = LayoutElement::ptr();
+      globalArena.unpin(viewMark_);
+      globalArena.rewind(viewMark_);
+    } else {
+      viewMark_ = globalArena.used();
+    }
+    buildView(view);
+    viewKey_ = view;
+    // the tree outlives this show(), and the ArenaMark around it.
+    globalArena.pin();
+  }
+
+  timeText_->setText(timeStr);
+  dateText_->setText(dayOfWeekStr + " " + monthStr + " " + dayOfMonthStr);
+  errorText_->setText(errorMessage);
+  if (tempText_) {
+    tempText_->setText(tempStr);
+  }
+  if (aqiText_) {
+    aqiText_->setText(aqiConvert(airQualityPM25));
+  }
+  if (stepsText_) {
+    stepsText_->setText(String(watchy->stepCounter()));
+  }
+  if (battText_) {
+    battText_->setText(String(watchy->battVoltage()));
   }
 
+  // the tree covers the whole screen, so the fillScreen above doesn't stop
+  // redraw() from working out which parts changed.
+  uint16_t w, h;
+  view_->redraw(display, 0, 0, display->width(), display->height(), &w, &h);
+
+  return APP_ACTIVE;
+}
+
+void CalendarApp::buildView(const CalendarViewKey &view) {
+  Watchy *watchy                  = view.watchy;
+  const uint16_t BACKGROUND_COLOR = watchy->backgroundColor();
+  uint16_t color                  = watchy->foregroundColor();
+
+  tempText_  = NULL;
+  aqiText_   = NULL;
+  stepsText_ = NULL;
+  battText_  = NULL;
+
   LayoutCell elemTop;
-  if (viewShowAboveCalendar) {
+  if (view.showAboveCalendar) {
+    LayoutRef<LayoutText> temp(LayoutText("", &Seven_Segment10pt7b, color));
+    tempText_ = temp.get();
     LayoutCell elemTempAndAirQuality;
-    if (airQualityPM25 >= 0 && weatherUpToDate) {
+    if (view.airQuality) {
+      LayoutRef<LayoutText> aqi(LayoutText("", &Seven_Segment10pt7b, color));
+      aqiText_ = aqi.get();
       elemTempAndAirQuality.set(LayoutRows({
-          LayoutEntry(
-              LayoutCenter(LayoutText(tempStr, &Seven_Segment10pt7b, color))),
+          LayoutEntry(LayoutCenter(temp)),
           LayoutEntry(LayoutSpacer(3)),
-          LayoutEntry(LayoutCenter(LayoutText(aqiConvert(airQualityPM25),
-                                              &Seven_Segment10pt7b, color))),
+          LayoutEntry(LayoutCenter(aqi)),
       }));
     } else {
-      elemTempAndAirQuality.set(
-          LayoutText(tempStr, &Seven_Segment10pt7b, color));
+      elemTempAndAirQuality.set(temp);
     }
 
+    LayoutRef<LayoutText> stepCount(
+        LayoutText("", &Seven_Segment10pt7b, color));
+    stepsText_ = stepCount.get();
+    LayoutRef<LayoutText> batt(LayoutText("", &Seven_Segment10pt7b, color));
+    battText_ = batt.get();
+    LayoutRef<LayoutText> clock(
+        LayoutText("", &DSEG7_Classic_Regular_39, color));
+    timeText_ = clock.get();
+
     elemTop.set(LayoutRows({
         LayoutEntry(LayoutColumns({
             LayoutEntry(LayoutVCenter(LayoutBitmap(steps, 19, 23, color))),
             LayoutEntry(LayoutSpacer(5)),
-            LayoutEntry(LayoutVCenter(LayoutText(String(watchy->stepCounter()),
-                                                 &Seven_Segment10pt7b, color))),
+            LayoutEntry(LayoutVCenter(stepCount)),
             LayoutEntry(LayoutFill(), true),
-            LayoutEntry(LayoutVCenter(LayoutText(String(watchy->battVoltage()),
-                                                 &Seven_Segment10pt7b, color))),
+            LayoutEntry(LayoutVCenter(batt)),
             LayoutEntry(LayoutSpacer(5)),
             LayoutEntry(LayoutVCenter(LayoutBattery(watchy, color))),
         })),
         LayoutEntry(LayoutSpacer(5)),
         LayoutEntry(LayoutColumns({
             LayoutEntry(LayoutSpacer(5)),
-            LayoutEntry(LayoutVCenter(
-                LayoutText(timeStr, &DSEG7_Classic_Regular_39, color))),
+            LayoutEntry(LayoutVCenter(clock)),
             LayoutEntry(LayoutSpacer(5)),
             LayoutEntry(LayoutFill(), true),
             LayoutEntry(LayoutVCenter(elemTempAndAirQuality)),
             LayoutEntry(LayoutSpacer(5)),
             LayoutEntry(LayoutVCenter(LayoutWeatherIcon(
-                weatherUpToDate, weatherConditionCode, color))),
+                view.weatherUpToDate, view.weatherConditionCode, color))),
         })),
     }));
   } else {
+    LayoutCell elemTempOrWiFi;
+    if (view.weatherUpToDate) {
+      LayoutRef<LayoutText> temp(LayoutText("", &Seven_Segment10pt7b, color));
+      tempText_ = temp.get();
+      elemTempOrWiFi.set(temp);
+    } else {
+      elemTempOrWiFi.set(LayoutBitmap(wifioff, 26, 18, color));
+    }
+
+    LayoutRef<LayoutText> clock(LayoutText("", &DSEG7_Classic_Bold_25, color));
+    timeText_ = clock.get();
+
     elemTop.set(LayoutColumns({
-        LayoutEntry(
-            LayoutVCenter(LayoutText(timeStr, &DSEG7_Classic_Bold_25, color))),
+        LayoutEntry(LayoutVCenter(clock)),
         LayoutEntry(LayoutFill(), true),
         LayoutEntry(LayoutVCenter(elemTempOrWiFi)),
         LayoutEntry(LayoutSpacer(5)),
@@ -381,58 +926,55 @@ AppState CalendarApp::show(Watchy *watchy, Display *display) {
     }));
   }
 
-  LayoutBottomAlign elemError(LayoutRightAlign(LayoutBackground(
-      LayoutPad(LayoutText(errorMessage, &Picopixel, color), 2, 2, 2, 2),
-      BACKGROUND_COLOR)));
+  LayoutRef<LayoutText> error(LayoutText("", &Picopixel, color));
+  errorText_ = error.get();
+  LayoutBottomAlign elemError(LayoutRightAlign(
+      LayoutBackground(LayoutPad(error, 2, 2, 2, 2), BACKGROUND_COLOR)));
 
   LayoutCell elemCalendar;
-  if (monthView) {
-    elemCalendar.set(CalendarMonth(&calendarDay, watchy, monthEventOffset,
-                                   !monthDayAbs, color));
+  if (view.monthView) {
+    elemCalendar.set(CalendarMonth(&eventPool, watchy, view.monthEventOffset,
+                                   !view.monthDayAbs, color));
   } else {
     std::vector<LayoutEntry, MemArenaAllocator<LayoutEntry>> calColumns(
         allocatorLayoutEntry);
-    calColumns.reserve(activeCalendarColumns + 1);
+    calColumns.reserve(view.columns + 1);
     calColumns.push_back(
-        LayoutEntry(CalendarHourBar(watchy, dayScheduleOffset, color)));
-    for (int i = 0; i < activeCalendarColumns; i++) {
+        LayoutEntry(CalendarHourBar(watchy, view.dayScheduleOffset, color)));
+    for (int i = 0; i < view.columns; i++) {
       calColumns.push_back(LayoutEntry(
-          CalendarColumn(&calendar[i], watchy, dayScheduleOffset, color),
+          CalendarColumn(&eventPool, i, watchy, view.dayScheduleOffset, color),
           true));
     }
     elemCalendar.set(LayoutRows({
-        LayoutEntry(
-            CalendarDayEvents(&calendarDay, watchy, dayScheduleOffset, color)),
+        LayoutEntry(CalendarDayEvents(&eventPool, watchy,
+                                      view.dayScheduleOffset, color)),
         LayoutEntry(LayoutColumns(calColumns), true),
     }));
   }
 
-  uint16_t w, h;
-  LayoutRows({
-                 LayoutEntry(elemTop),
-                 LayoutEntry(LayoutSpacer(5)),
-                 LayoutEntry(
-                     LayoutColumns({
-                         LayoutEntry(LayoutRows({
-                             LayoutEntry(LayoutRotate(
-                                 LayoutText(dayOfWeekStr + " " + monthStr +
-                                                " " + dayOfMonthStr,
-                                            &Seven_Segment10pt7b, color),
-                                 3)),
-                             LayoutEntry(LayoutFill(), true),
-                         })),
-                         LayoutEntry(LayoutSpacer(5)),
-                         LayoutEntry(LayoutBorder(
-                                         LayoutOverlay(elemCalendar, elemError),
-                                         true, false, true, true, color),
-                                     true),
-                     }),
-                     true),
-                 LayoutEntry(CalendarAlarms(&alarms, watchy, color)),
-             })
-      .draw(display, 0, 0, display->width(), display->height(), &w, &h);
+  LayoutRef<LayoutText> date(LayoutText("", &Seven_Segment10pt7b, color));
+  dateText_ = date.get();
 
-  return APP_ACTIVE;
+  view_ = LayoutRows({
+              LayoutEntry(elemTop),
+              LayoutEntry(LayoutSpacer(5)),
+              LayoutEntry(
+                  LayoutColumns({
+                      LayoutEntry(LayoutRows({
+                          LayoutEntry(LayoutRotate(date, 3)),
+                          LayoutEntry(LayoutFill(), true),
+                      })),
+                      LayoutEntry(LayoutSpacer(5)),
+                      LayoutEntry(
+                          LayoutBorder(LayoutOverlay(elemCalendar, elemError),
+                                       true, false, true, true, color),
+                          true),
+                  }),
+                  true),
+              LayoutEntry(CalendarAlarms(&eventPool, watchy, color)),
+          })
+              .clone();
 }
 
 void CalendarApp::buttonDown(Watchy *watchy) {
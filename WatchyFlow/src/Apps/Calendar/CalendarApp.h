@@ -1,8 +1,11 @@
 #pragma once
 
 #include "../../Watchy/WatchyApp.h"
+#include "../../Layout/Layout.h"
 #include "../Alerts/AlertsApp.h"
 
+struct CalendarFetch;
+
 typedef struct LocationConfig {
   String name;
   String weatherURL;
@@ -21,15 +24,36 @@ typedef struct CalendarSettings {
   int locationCount;
 } CalendarSettings;
 
+// CalendarViewKey is everything that decides the shape of the layout tree
+// CalendarApp draws. While it stays the same, the tree is reused.
+typedef struct CalendarViewKey {
+  Watchy *watchy;
+  bool monthView;
+  bool showAboveCalendar;
+  bool monthDayAbs;
+  bool weatherUpToDate;
+  bool airQuality;
+  int16_t weatherConditionCode;
+  uint8_t columns;
+  int32_t dayScheduleOffset;
+  int32_t monthEventOffset;
+} CalendarViewKey;
+
 class CalendarApp : public WatchyApp {
 public:
   explicit CalendarApp(CalendarSettings settings)
-      : settings_(settings), forceCacheMiss_(false), alerts_(NULL) {}
+      : settings_(settings), forceCacheMiss_(false), alerts_(NULL),
+        viewMark_(0) {}
   CalendarApp(CalendarSettings settings, AlertsApp *alerts)
-      : settings_(settings), forceCacheMiss_(false), alerts_(alerts) {}
+      : settings_(settings), forceCacheMiss_(false), alerts_(alerts),
+        viewMark_(0) {}
+
+  CalendarApp(const CalendarApp &copy)            = delete;
+  CalendarApp &operator=(const CalendarApp &copy) = delete;
 
   AppState show(Watchy *watchy, Display *display) override;
   FetchState fetchNetwork(Watchy *watchy) override;
+  FetchPace fetchPace(Watchy *watchy) override;
   void tick(Watchy *watchy) override;
 
   void reset(Watchy *watchy) override;
@@ -46,10 +70,41 @@ public:
   void setActiveLocation(int location);
 
 private:
-  void parseCalendar(Watchy *watchy, String payload);
+  // each of these makes one of fetchNetwork()'s requests, which run in
+  // parallel, and returns whether it succeeded.
+  bool fetchCalendar(CalendarFetch *fetch);
+  bool fetchWeather(CalendarFetch *fetch);
+  bool fetchAirQuality(CalendarFetch *fetch);
+
+  // readCalendar decodes the calendar server's response into RTC memory,
+  // whether it's in the binary format or, from a server that doesn't have
+  // that, JSON. Any weather and air quality the server sent along is put in
+  // fetch. It returns false if the response is malformed or cut short, and
+  // leaves the calendar as it was.
+  bool readCalendar(Stream *stream, CalendarFetch *fetch);
+  // inSilenceWindow is whether event start vibrations are silenced at local.
+  bool inSilenceWindow(const tmElements_t &local);
+  // addTriggers asks for a tick() at the next event and alarm starts, and at
+  // midnight to reset the step counter.
+  void addTriggers(Watchy *watchy);
+  void buildView(const CalendarViewKey &view);
 
 private:
   CalendarSettings settings_;
   bool forceCacheMiss_;
   AlertsApp *alerts_;
+
+  // the layout tree from the last show(), and the elements in it that get
+  // updated in place. these only last until the next deep sleep.
+  LayoutElement::ptr view_;
+  CalendarViewKey viewKey_;
+  // viewMark_ is how much of globalArena was in use before view_ was built.
+  size_t viewMark_;
+  LayoutText *timeText_;
+  LayoutText *dateText_;
+  LayoutText *errorText_;
+  LayoutText *tempText_;
+  LayoutText *aqiText_;
+  LayoutText *stepsText_;
+  LayoutText *battText_;
 };
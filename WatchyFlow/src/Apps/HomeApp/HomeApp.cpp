@@ -12,10 +12,11 @@ AppState HomeApp::show(Watchy *watchy, Display *display) {
 
 FetchState HomeApp::fetchNetwork(Watchy *watchy) {
   FetchState fetchState = home_->fetchNetwork(watchy);
-  if (menu_->fetchNetwork(watchy) == FETCH_TRYAGAIN) {
-    fetchState = FETCH_TRYAGAIN;
-  }
-  return fetchState;
+  return combineFetchStates(fetchState, menu_->fetchNetwork(watchy));
+}
+
+FetchPace HomeApp::fetchPace(Watchy *watchy) {
+  return combineFetchPaces(home_->fetchPace(watchy), menu_->fetchPace(watchy));
 }
 
 void HomeApp::tick(Watchy *watchy) {
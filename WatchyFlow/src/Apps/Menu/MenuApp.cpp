@@ -41,15 +41,22 @@ AppState MenuApp::show(Watchy *watchy, Display *display) {
 }
 
 FetchState MenuApp::fetchNetwork(Watchy *watchy) {
-  FetchState fetchState = FETCH_OK;
+  FetchState fetchState = FETCH_NOCHANGE;
   for (uint16_t i = 0; i < items_.size(); i++) {
-    if (items_[i].app_->fetchNetwork(watchy) == FETCH_TRYAGAIN) {
-      fetchState = FETCH_TRYAGAIN;
-    }
+    fetchState =
+        combineFetchStates(fetchState, items_[i].app_->fetchNetwork(watchy));
   }
   return fetchState;
 }
 
+FetchPace MenuApp::fetchPace(Watchy *watchy) {
+  FetchPace pace = FETCH_PACE_ANY;
+  for (uint16_t i = 0; i < items_.size(); i++) {
+    pace = combineFetchPaces(pace, items_[i].app_->fetchPace(watchy));
+  }
+  return pace;
+}
+
 void MenuApp::tick(Watchy *watchy) {
   for (uint16_t i = 0; i < items_.size(); i++) {
     items_[i].app_->tick(watchy);
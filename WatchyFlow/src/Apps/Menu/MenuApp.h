@@ -43,6 +43,7 @@ public:
 
   AppState show(Watchy *watchy, Display *display) override;
   FetchState fetchNetwork(Watchy *watchy) override;
+  FetchPace fetchPace(Watchy *watchy) override;
 
   void reset(Watchy *watchy) override;
   void buttonUp(Watchy *watchy) override;
@@ -1,5 +1,6 @@
 #include "Stopwatch.h"
 #include "../../Layout/Layout.h"
+#include "../../Layout/Static.h"
 #include "../../Elements/Buttons.h"
 #include "../../Fonts/DSEG7_Classic_Regular_39.h"
 #include "../../Fonts/Seven_Segment10pt7b.h"
@@ -54,17 +55,15 @@ AppState StopwatchApp::show(Watchy *watchy, Display *display) {
   LayoutButtonLabels(
       watchy, "Back", running_ ? "Stop" : "Start", "Split",
       running_ ? "Refresh" : "Reset", NULL, FOREGROUND_COLOR, false,
-      LayoutVCenter(LayoutRows({
-          LayoutEntry(LayoutHCenter(
-              LayoutText(split, &Seven_Segment10pt7b, FOREGROUND_COLOR))),
-          LayoutEntry(LayoutSpacer(5)),
-          LayoutEntry(LayoutHCenter(
-              LayoutText(time, &DSEG7_Classic_Regular_39, FOREGROUND_COLOR))),
-          LayoutEntry(LayoutSpacer(5)),
-          LayoutEntry(
-              LayoutHCenter(LayoutText(running_ ? "Running..." : "Stopped",
-                                       &FreeSans9pt7b, FOREGROUND_COLOR))),
-      })))
+      layoutStatic(staticVCenter(staticRows(
+          staticHCenter(staticText(split.c_str(), &Seven_Segment10pt7b,
+                                   FOREGROUND_COLOR)),
+          staticSpacer(5),
+          staticHCenter(staticText(time.c_str(), &DSEG7_Classic_Regular_39,
+                                   FOREGROUND_COLOR)),
+          staticSpacer(5),
+          staticHCenter(staticText(running_ ? "Running..." : "Stopped",
+                                   &FreeSans9pt7b, FOREGROUND_COLOR))))))
       .draw(display, 0, 0, display->width(), display->height(), &w, &h);
 
   return APP_ACTIVE;
@@ -1,5 +1,6 @@
 #include "Timer.h"
 #include "../../Layout/Layout.h"
+#include "../../Layout/Static.h"
 #include "../../Elements/Buttons.h"
 #include "../../Fonts/DSEG7_Classic_Regular_39.h"
 #include "../../Fonts/Seven_Segment10pt7b.h"
@@ -49,6 +50,10 @@ void TimerApp::tick(Watchy *watchy) {
     // safe to do twice, even if alerts_ takes care of it. will get debounced.
     watchy->queueVibrate(100, 10);
   }
+  if (running_) {
+    // the minute after the one it runs out in, so that it's run out by then.
+    watchy->addTrigger(expiry_ + 59);
+  }
 }
 
 AppState TimerApp::show(Watchy *watchy, Display *display) {
@@ -72,14 +77,13 @@ AppState TimerApp::show(Watchy *watchy, Display *display) {
   LayoutButtonLabels(
       watchy, "Back", running ? "Stop" : "Start", running ? "" : "More",
       running ? "Refresh" : "Less", NULL, FOREGROUND_COLOR, false,
-      LayoutVCenter(LayoutRows({
-          LayoutEntry(LayoutHCenter(LayoutText(
-              remainingStr, &DSEG7_Classic_Regular_39, FOREGROUND_COLOR))),
-          LayoutEntry(LayoutSpacer(5)),
-          LayoutEntry(
-              LayoutHCenter(LayoutText(running ? "Running..." : "Stopped",
-                                       &FreeSans9pt7b, FOREGROUND_COLOR))),
-      })))
+      layoutStatic(staticVCenter(staticRows(
+          staticHCenter(staticText(remainingStr.c_str(),
+                                   &DSEG7_Classic_Regular_39,
+                                   FOREGROUND_COLOR)),
+          staticSpacer(5),
+          staticHCenter(staticText(running ? "Running..." : "Stopped",
+                                   &FreeSans9pt7b, FOREGROUND_COLOR))))))
       .draw(display, 0, 0, display->width(), display->height(), &w, &h);
 
   return APP_ACTIVE;
@@ -132,6 +136,7 @@ AppState TimerApp::buttonSelect(Watchy *watchy) {
   running_   = true;
   time_t now = watchy->unixtime();
   expiry_    = now + minutes_ * 60;
+  watchy->addTrigger(expiry_ + 59);
   return APP_ACTIVE;
 }
 
@@ -19,7 +19,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutBattery>(*this);
+    return LayoutElement::ptr(new LayoutBattery(*this));
   }
 
 private:
@@ -34,5 +34,5 @@ void LayoutWeatherIcon::draw(Display *display, int16_t x0, int16_t y0,
   }
 
   LayoutBitmap elem(weatherIcon, 48, 32, color_);
-  elem.draw(display, x0, y0, targetWidth, targetHeight, width, height);
+  elem.render(display, x0, y0, targetWidth, targetHeight, width, height);
 }
@@ -9,10 +9,11 @@ class LayoutWeatherIcon : public LayoutElement {
 public:
   explicit LayoutWeatherIcon(bool upToDate, int16_t conditionCode,
                              uint16_t color)
-      : upToDate_(upToDate), weather_(conditionCode), color_(color) {}
+      : LayoutElement(LAYOUT_STABLE), upToDate_(upToDate),
+        weather_(conditionCode), color_(color) {}
   LayoutWeatherIcon(const LayoutWeatherIcon &copy)
-      : upToDate_(copy.upToDate_), weather_(copy.weather_),
-        color_(copy.color_) {}
+      : LayoutElement(LAYOUT_STABLE), upToDate_(copy.upToDate_),
+        weather_(copy.weather_), color_(copy.color_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -21,7 +22,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutWeatherIcon>(*this);
+    return LayoutElement::ptr(new LayoutWeatherIcon(*this));
   }
 
 private:
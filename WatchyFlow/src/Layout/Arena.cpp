@@ -1,9 +1,26 @@
 #include "Arena.h"
+#include <Arduino.h>
 
-MemArena::MemArena(size_t size) : size_(size) {
-  begin_   = static_cast<char *>(::operator new(size));
-  end_     = begin_ + size;
-  current_ = begin_;
+namespace {
+RTC_DATA_ATTR uint32_t scopePeaks_[ARENA_SCOPE_COUNT];
+RTC_DATA_ATTR uint16_t overflows_;
+} // namespace
+
+MemArena::MemArena(size_t size, size_t reserve)
+    : reserve_(nullptr), peak_(0), pinned_(0) {
+  block_ = static_cast<Block *>(::operator new(sizeof(Block) + size));
+  block_->prev = nullptr;
+  block_->next = nullptr;
+  block_->base = 0;
+  block_->size = size;
+  current_     = block_->data();
+  end_         = current_ + size;
+  if (reserve > 0) {
+    reserve_ = newBlock(reserve);
+    if (reserve_) {
+      reserve_->size = reserve;
+    }
+  }
 }
 
 MemArena::~MemArena() {
@@ -11,21 +28,121 @@ MemArena::~MemArena() {
   // ::operator delete(begin_);
 }
 
-void *MemArena::allocate(size_t requested, size_t alignment) {
-  void *current = current_;
-  size_t space  = end_ - current_;
+MemArena::Block *MemArena::newBlock(size_t size) {
+  void *mem = nullptr;
+#ifdef BOARD_HAS_PSRAM
+  if (psramFound()) {
+    mem = ps_malloc(sizeof(Block) + size);
+  }
+#endif
+  if (!mem) {
+    mem = malloc(sizeof(Block) + size);
+  }
+  return static_cast<Block *>(mem);
+}
+
+void *MemArena::grow(size_t requested, size_t alignment) {
+  // the allocation always fits at the start of a block this big.
+  size_t needed = requested + alignment;
+
+  Block *next = block_->next;
+  if (!next || next->size < needed) {
+    // blocks after this one are unused, so a new block can go in front of them.
+    size_t size = block_->size * 2;
+    if (size < needed) {
+      size = needed;
+    }
+    Block *block = newBlock(size);
+    if (!block && size > needed) {
+      size  = needed;
+      block = newBlock(size);
+    }
+    if (!block && reserve_ && reserve_->size >= needed) {
+      block    = reserve_;
+      size     = reserve_->size;
+      reserve_ = nullptr;
+    }
+    if (overflows_ < UINT16_MAX) {
+      overflows_++;
+    }
+    if (!block) {
+      return nullptr;
+    }
+    block->size = size;
+    block->prev = block_;
+    block->next = next;
+    if (next) {
+      next->prev = block;
+    }
+    block_->next = block;
+    next         = block;
+  }
+
+  next->base = block_->base + block_->size;
+  block_     = next;
+  current_   = next->data();
+  end_       = current_ + next->size;
+  return allocate(requested, alignment);
+}
 
-  if (!std::align(alignment, requested, current, space) ||
-      static_cast<char *>(current) + requested > end_) {
-    throw std::bad_alloc();
+size_t MemArena::remaining() {
+  size_t remaining = end_ - current_;
+  for (Block *block = block_->next; block; block = block->next) {
+    remaining += block->size;
   }
+  return remaining;
+}
 
-  current_ = static_cast<char *>(current) + requested;
-  return current;
+size_t MemArena::blocks() {
+  size_t blocks = 0;
+  for (Block *block = block_; block; block = block->prev) {
+    blocks++;
+  }
+  for (Block *block = block_->next; block; block = block->next) {
+    blocks++;
+  }
+  return blocks;
 }
 
 void MemArena::deallocate(void *ptr, size_t size) noexcept {
   // deliberately disabled
 }
 
-MemArena globalArena(16 * 1024);
+void MemArena::rewind(size_t mark) {
+  if (mark < pinned_) {
+    mark = pinned_;
+  }
+  if (mark >= used()) {
+    return;
+  }
+  // later blocks stay chained, to be used again before any new ones.
+  while (mark < block_->base) {
+    block_ = block_->prev;
+  }
+  current_ = block_->data() + (mark - block_->base);
+  end_     = block_->data() + block_->size;
+}
+
+ArenaMark::~ArenaMark() {
+  if (scope_ != ARENA_SCOPE_NONE && peak() > scopePeaks_[scope_]) {
+    scopePeaks_[scope_] = peak();
+  }
+  arena_.restorePeak(outerPeak_);
+  arena_.rewind(mark_);
+}
+
+size_t arenaScopePeak(ArenaScope scope) { return scopePeaks_[scope]; }
+
+void resetArenaScopePeaks() {
+  for (int i = 0; i < ARENA_SCOPE_COUNT; i++) {
+    scopePeaks_[i] = 0;
+  }
+}
+
+size_t arenaOverflows() { return overflows_; }
+
+void resetArenaOverflows() { overflows_ = 0; }
+
+// the reserve is for when the heap has run out, so it's taken at startup
+// while there's still plenty.
+MemArena globalArena(16 * 1024, 2 * 1024);
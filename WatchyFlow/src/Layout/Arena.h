@@ -8,30 +8,141 @@
 // heap space? If we're going to use the heap, we might as well not worry
 // about spending time deallocating and keeping the memory pool tidy.
 // So this is a no-op deallocating memory arena.
+//
+// The arena starts as a single block. If a busy frame fills it, another block
+// twice the size of the last one is chained on, from PSRAM when the board has
+// it, rather than failing the allocation. Positions like used() and the marks
+// given to rewind() count across all the blocks, with whatever was left at the
+// end of a filled block counted as used.
+//
+// If no new block can be had, a reserve block set aside when the arena was
+// made is chained on instead. Once that's gone too, allocate() returns NULL.
 class MemArena {
 public:
-  explicit MemArena(size_t size);
+  explicit MemArena(size_t size, size_t reserve = 0);
 
   MemArena(const MemArena &copy)        = delete;
   MemArena &operator=(const MemArena &) = delete;
 
   ~MemArena();
 
-  void *allocate(size_t requested, size_t alignment);
+  void *allocate(size_t requested, size_t alignment) {
+    void *current = current_;
+    size_t space  = end_ - current_;
+    if (!std::align(alignment, requested, current, space)) {
+      return grow(requested, alignment);
+    }
+    current_ = static_cast<char *>(current) + requested;
+    if (used() > peak_) {
+      peak_ = used();
+    }
+    return current;
+  }
   void deallocate(void *ptr, size_t size) noexcept;
 
-  size_t used() { return current_ - begin_; }
-  size_t remaining() { return end_ - current_; }
+  size_t used() { return block_->base + (current_ - block_->data()); }
+  // remaining() is what's left in the current block and any blocks already
+  // chained after it.
+  size_t remaining();
+  // blocks() is how many blocks the arena has chained together so far.
+  size_t blocks();
+  // peak() is the most that used() has been since the last resetPeak().
+  size_t peak() { return peak_; }
+  void resetPeak() { peak_ = used(); }
+  void restorePeak(size_t peak) {
+    if (peak > peak_) {
+      peak_ = peak;
+    }
+  }
+
+  // rewind() gives back everything allocated since used() returned mark,
+  // except what has been pinned. Nothing allocated after mark may be used
+  // afterwards. Usually an ArenaMark does this.
+  void rewind(size_t mark);
+
+  // pin() keeps everything allocated so far from being given back by
+  // rewind(), for things that must outlive the scope that allocated them,
+  // such as a layout tree an App keeps from frame to frame. unpin() lets
+  // rewind() give back everything since mark again.
+  void pin() { pinned_ = used(); }
+  void unpin(size_t mark) {
+    if (mark < pinned_) {
+      pinned_ = mark;
+    }
+  }
 
 private:
-  size_t size_;
-  char *begin_;
+  typedef struct Block {
+    Block *prev;
+    Block *next;
+    // base is where the block starts, counting from the start of the arena.
+    size_t base;
+    size_t size;
+    char *data() { return reinterpret_cast<char *>(this + 1); }
+  } Block;
+
+  void *grow(size_t requested, size_t alignment);
+  static Block *newBlock(size_t size);
+
+  Block *block_;
+  // reserve_ is the reserve block until it's chained on.
+  Block *reserve_;
   char *end_;
   char *current_;
+  size_t peak_;
+  size_t pinned_;
 };
 
 extern MemArena globalArena;
 
+// arenaOverflows returns how many times since the last resetArenaOverflows()
+// an allocation didn't fit in the arena's block and another block had to be
+// chained on, or nothing could be and the allocation failed. It's a sign
+// globalArena should start bigger.
+size_t arenaOverflows();
+void resetArenaOverflows();
+
+// ArenaScope names the scopes that record their peak arena use in RTC memory,
+// so the arena size can be checked against what the watch actually needs.
+typedef enum ArenaScope {
+  ARENA_SCOPE_NONE = -1,
+  // an App's show(), in Watchy::updateScreen().
+  ARENA_SCOPE_SHOW = 0,
+  // Watchy::drawNotice().
+  ARENA_SCOPE_NOTICE = 1,
+  ARENA_SCOPE_COUNT  = 2,
+} ArenaScope;
+
+// arenaScopePeak returns the most bytes a scope has used at once since the
+// last resetArenaScopePeaks().
+size_t arenaScopePeak(ArenaScope scope);
+void resetArenaScopePeaks();
+
+// ArenaMark gives back everything allocated from arena during its lifetime
+// when it goes out of scope, except what was pinned. If scope isn't
+// ARENA_SCOPE_NONE, it also records how much the scope used at most.
+class ArenaMark {
+public:
+  explicit ArenaMark(MemArena &arena, ArenaScope scope = ARENA_SCOPE_NONE)
+      : arena_(arena), scope_(scope), mark_(arena.used()),
+        outerPeak_(arena.peak()) {
+    arena_.resetPeak();
+  }
+  ~ArenaMark();
+
+  ArenaMark(const ArenaMark &)            = delete;
+  ArenaMark &operator=(const ArenaMark &) = delete;
+
+  // peak is the most bytes allocated at once since the mark.
+  size_t peak() { return arena_.peak() - mark_; }
+
+private:
+  MemArena &arena_;
+  ArenaScope scope_;
+  size_t mark_;
+  size_t outerPeak_;
+};
+
 // This makes it so the Memory Arena can be used for std containers.
 template <typename T> class MemArenaAllocator {
 public:
@@ -48,7 +159,12 @@ public:
       : arena_(copy.arena_) {}
 
   T *allocate(size_t n) {
-    return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+    void *p = arena_->allocate(n * sizeof(T), alignof(T));
+    if (!p) {
+      // std containers can't be given NULL.
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(p);
   }
 
   void deallocate(T *p, size_t n) noexcept {
@@ -1,9 +1,10 @@
 #include "Layout.h"
+#include "TextMetrics.h"
 
-static void *LayoutElement::operator new(size_t size) {
+static void *LayoutElement::operator new(size_t size) noexcept {
   return globalArena.allocate(size, alignof(LayoutElement));
 }
-static void *LayoutElement::operator new[](size_t size) {
+static void *LayoutElement::operator new[](size_t size) noexcept {
   return globalArena.allocate(size, alignof(LayoutElement));
 }
 static void LayoutElement::operator delete(void *ptr, size_t size) noexcept {
@@ -19,6 +20,202 @@ static void LayoutElement::operator delete[](void *ptr) noexcept {
   globalArena.deallocate(ptr, -1);
 }
 
+LayoutStats layoutStats;
+LayoutRect layoutDamage = {0, 0, WatchyDisplay::WIDTH, WatchyDisplay::HEIGHT};
+uint16_t LayoutElement::frame_                    = 1;
+const LayoutElement *LayoutElement::frameRoot_    = NULL;
+const LayoutElement *LayoutElement::previousRoot_ = NULL;
+bool LayoutElement::trackDamage_                  = false;
+LayoutRect LayoutElement::overlayDamage_          = {0, 0, 0, 0};
+
+namespace {
+
+// unrotate turns a rectangle drawn with the display's current rotation into
+// unrotated display coordinates, the same way the display turns pixels.
+LayoutRect unrotate(Display *display, int16_t x, int16_t y, uint16_t w,
+                    uint16_t h) {
+  LayoutRect r;
+  switch (display->getRotation()) {
+  default:
+    r = {x, y, w, h};
+    break;
+  case 1:
+    r = {(int16_t)(WatchyDisplay::WIDTH - y - h), x, h, w};
+    break;
+  case 2:
+    r = {(int16_t)(WatchyDisplay::WIDTH - x - w),
+         (int16_t)(WatchyDisplay::HEIGHT - y - h), w, h};
+    break;
+  case 3:
+    r = {y, (int16_t)(WatchyDisplay::HEIGHT - x - w), h, w};
+    break;
+  }
+  return r;
+}
+
+// LayoutMissing takes no space and draws nothing.
+class LayoutMissing : public LayoutElement {
+public:
+  LayoutMissing() : LayoutElement(LAYOUT_SELF_CONTAINED) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) override {
+    *width  = 0;
+    *height = 0;
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) override {
+    *width  = 0;
+    *height = 0;
+  }
+
+  LayoutElement::ptr clone() const override {
+    return LayoutElement::ptr(new LayoutMissing());
+  }
+};
+
+LayoutMissing missingElement;
+
+bool sameRect(const LayoutRect &a, const LayoutRect &b) {
+  return a.x == b.x && a.y == b.y && a.width == b.width &&
+         a.height == b.height;
+}
+
+// addDamage grows damage to cover r.
+void addDamage(LayoutRect &damage, const LayoutRect &r) {
+  if (r.width == 0 || r.height == 0) {
+    return;
+  }
+  if (damage.width == 0 || damage.height == 0) {
+    damage = r;
+    return;
+  }
+  int16_t x1 = damage.x + damage.width;
+  int16_t y1 = damage.y + damage.height;
+  if (r.x + r.width > x1) {
+    x1 = r.x + r.width;
+  }
+  if (r.y + r.height > y1) {
+    y1 = r.y + r.height;
+  }
+  if (r.x < damage.x) {
+    damage.x = r.x;
+  }
+  if (r.y < damage.y) {
+    damage.y = r.y;
+  }
+  damage.width  = x1 - damage.x;
+  damage.height = y1 - damage.y;
+}
+
+// startAnyFrame is what startFrame() and startOverlay() have in common.
+void startAnyFrame(uint16_t &frame) {
+  // a freshly constructed element has measuredFrame_ == 0, so skip 0 when
+  // wrapping around.
+  if (++frame == 0) {
+    frame = 1;
+  }
+  layoutStats.measureCalls = 0;
+  layoutStats.sizeCalls    = 0;
+  layoutStats.drawCalls    = 0;
+  forgetTextBounds();
+  layoutDamage = {0, 0, WatchyDisplay::WIDTH, WatchyDisplay::HEIGHT};
+}
+
+} // namespace
+
+LayoutElement *LayoutElement::missing() {
+  LayoutElement *elem = &missingElement;
+  // it isn't from the arena, so it must never be deleted.
+  if (elem->refs_ == 0) {
+    elem->refs_ = 1;
+  }
+  return elem;
+}
+
+void LayoutElement::measure(Display *display, uint16_t targetWidth,
+                            uint16_t targetHeight, uint16_t *width,
+                            uint16_t *height) {
+  layoutStats.measureCalls++;
+  bool remembered;
+  if (depends_ == LAYOUT_SELF_CONTAINED) {
+    // self-contained elements are the same size whatever the target, and stay
+    // that size until they call forgetMeasurement().
+    remembered = measuredFrame_ != 0;
+  } else {
+    remembered = measuredFrame_ == frame_ &&
+                 measuredTargetWidth_ == targetWidth &&
+                 measuredTargetHeight_ == targetHeight;
+  }
+  if (remembered) {
+    *width  = measuredWidth_;
+    *height = measuredHeight_;
+    return;
+  }
+  layoutStats.sizeCalls++;
+  size(display, targetWidth, targetHeight, width, height);
+  measuredFrame_        = frame_;
+  measuredTargetWidth_  = targetWidth;
+  measuredTargetHeight_ = targetHeight;
+  measuredWidth_        = *width;
+  measuredHeight_       = *height;
+}
+
+void LayoutElement::render(Display *display, int16_t x0, int16_t y0,
+                           uint16_t targetWidth, uint16_t targetHeight,
+                           uint16_t *width, uint16_t *height) {
+  layoutStats.drawCalls++;
+  draw(display, x0, y0, targetWidth, targetHeight, width, height);
+
+  // an element that is new, changed, moved, or volatile may look different
+  // both where it was and where it is now.
+  LayoutRect rect = unrotate(display, x0, y0, *width, *height);
+  if (trackDamage_ && (depends_ == LAYOUT_VOLATILE || !drawn_ || changed_ ||
+                       !sameRect(rect, drawnRect_))) {
+    if (drawn_) {
+      addDamage(layoutDamage, drawnRect_);
+    }
+    addDamage(layoutDamage, rect);
+  }
+  drawnRect_ = rect;
+  drawn_     = true;
+  changed_   = false;
+}
+
+void LayoutElement::redraw(Display *display, int16_t x0, int16_t y0,
+                           uint16_t targetWidth, uint16_t targetHeight,
+                           uint16_t *width, uint16_t *height) {
+  frameRoot_ = this;
+  if (previousRoot_ == this && drawn_) {
+    // anything drawn over the last frame has to be drawn over again.
+    layoutDamage = overlayDamage_;
+    trackDamage_ = true;
+  }
+  overlayDamage_ = {0, 0, 0, 0};
+  render(display, x0, y0, targetWidth, targetHeight, width, height);
+  trackDamage_ = false;
+}
+
+void LayoutElement::startFrame() {
+  // whatever drew the last frame, if it wasn't a redraw(), may have drawn
+  // anywhere.
+  startAnyFrame(frame_);
+  previousRoot_ = frameRoot_;
+  frameRoot_    = NULL;
+}
+
+void LayoutElement::startOverlay() {
+  // the last frame is still underneath, so it's still what the next frame
+  // gets compared to.
+  startAnyFrame(frame_);
+}
+
+void LayoutElement::overlaid(Display *display, int16_t x, int16_t y,
+                             uint16_t width, uint16_t height) {
+  addDamage(overlayDamage_, unrotate(display, x, y, width, height));
+}
+
 void LayoutText::size(Display *display, uint16_t targetWidth,
                       uint16_t targetHeight, uint16_t *width,
                       uint16_t *height) {
@@ -28,8 +225,7 @@ void LayoutText::size(Display *display, uint16_t targetWidth,
     return;
   }
   int16_t x1, y1;
-  display->setFont(font_);
-  display->getTextBounds(text_, 0, 0, &x1, &y1, width, height);
+  textBounds(display, font_, text_, &x1, &y1, width, height);
 }
 
 void LayoutText::draw(Display *display, int16_t x0, int16_t y0,
@@ -41,8 +237,7 @@ void LayoutText::draw(Display *display, int16_t x0, int16_t y0,
     return;
   }
   int16_t x1, y1;
-  display->setFont(font_);
-  display->getTextBounds(text_, 0, 0, &x1, &y1, width, height);
+  textBounds(display, font_, text_, &x1, &y1, width, height);
   display->setTextColor(color_);
   display->setCursor(x0 - x1, y0 - y1);
   display->print(text_);
@@ -57,7 +252,7 @@ void LayoutRotate::size(Display *display, uint16_t targetWidth,
     targetWidth  = targetHeight;
     targetHeight = swap;
   }
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
   if (rotate_ == 1 || rotate_ == 3) {
     swap    = *width;
     *width  = *height;
@@ -74,7 +269,7 @@ void LayoutRotate::draw(Display *display, int16_t x0, int16_t y0,
     targetWidth  = targetHeight;
     targetHeight = swap;
   }
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
 
   switch (rotate_) {
   default:
@@ -103,7 +298,7 @@ void LayoutRotate::draw(Display *display, int16_t x0, int16_t y0,
 
   uint8_t currentRotation = display->getRotation();
   display->setRotation((currentRotation + rotate_) % 4);
-  child_->draw(display, x0, y0, targetWidth, targetHeight, width, height);
+  child_->render(display, x0, y0, targetWidth, targetHeight, width, height);
   display->setRotation(currentRotation);
   if (rotate_ == 1 || rotate_ == 3) {
     swap    = *width;
@@ -115,7 +310,7 @@ void LayoutRotate::draw(Display *display, int16_t x0, int16_t y0,
 MemArenaAllocator<LayoutEntry> allocatorLayoutEntry(globalArena);
 
 LayoutColumns::LayoutColumns(std::initializer_list<LayoutEntry> elems)
-    : elems_(allocatorLayoutEntry) {
+    : LayoutElement(LAYOUT_STABLE), elems_(allocatorLayoutEntry) {
   elems_.reserve(elems.size());
   for (const LayoutEntry &info : elems) {
     elems_.push_back(info);
@@ -134,8 +329,8 @@ void LayoutColumns::size(Display *display, uint16_t targetWidth,
       canStretch = true;
     }
     uint16_t columnWidth, columnHeight;
-    elems_[i].elem_->size(display, 0, targetHeight, &columnWidth,
-                          &columnHeight);
+    elems_[i].elem_->measure(display, 0, targetHeight, &columnWidth,
+                             &columnHeight);
     if (columnHeight > *height) {
       *height = columnHeight;
     }
@@ -155,7 +350,8 @@ void LayoutColumns::draw(Display *display, int16_t x0, int16_t y0,
 
   for (uint16_t i = 0; i < elems_.size(); i++) {
     uint16_t subwidth, subheight;
-    elems_[i].elem_->size(display, 0, targetHeight, &subwidth, &subheight);
+    elems_[i].elem_->measure(display, 0, targetHeight, &subwidth,
+                             &subheight);
     if (subheight > targetHeight) {
       targetHeight = subheight;
     }
@@ -181,8 +377,8 @@ void LayoutColumns::draw(Display *display, int16_t x0, int16_t y0,
       splits--;
     }
     uint16_t subwidth, subheight;
-    elems_[i].elem_->draw(display, x0 + *width, y0, subTargetWidth,
-                          targetHeight, &subwidth, &subheight);
+    elems_[i].elem_->render(display, x0 + *width, y0, subTargetWidth,
+                            targetHeight, &subwidth, &subheight);
     *width += subwidth;
     if (subheight > *height) {
       *height = subheight;
@@ -191,7 +387,7 @@ void LayoutColumns::draw(Display *display, int16_t x0, int16_t y0,
 }
 
 LayoutRows::LayoutRows(std::initializer_list<LayoutEntry> elems)
-    : elems_(allocatorLayoutEntry) {
+    : LayoutElement(LAYOUT_STABLE), elems_(allocatorLayoutEntry) {
   elems_.reserve(elems.size());
   for (const LayoutEntry &info : elems) {
     elems_.push_back(info);
@@ -210,7 +406,7 @@ void LayoutRows::size(Display *display, uint16_t targetWidth,
       canStretch = true;
     }
     uint16_t rowWidth, rowHeight;
-    elems_[i].elem_->size(display, targetWidth, 0, &rowWidth, &rowHeight);
+    elems_[i].elem_->measure(display, targetWidth, 0, &rowWidth, &rowHeight);
     if (rowWidth > *width) {
       *width = rowWidth;
     }
@@ -230,7 +426,7 @@ void LayoutRows::draw(Display *display, int16_t x0, int16_t y0,
 
   for (uint16_t i = 0; i < elems_.size(); i++) {
     uint16_t subwidth, subheight;
-    elems_[i].elem_->size(display, targetWidth, 0, &subwidth, &subheight);
+    elems_[i].elem_->measure(display, targetWidth, 0, &subwidth, &subheight);
     if (subwidth > targetWidth) {
       targetWidth = subwidth;
     }
@@ -256,8 +452,8 @@ void LayoutRows::draw(Display *display, int16_t x0, int16_t y0,
       splits--;
     }
     uint16_t subwidth, subheight;
-    elems_[i].elem_->draw(display, x0, y0 + *height, targetWidth,
-                          subTargetHeight, &subwidth, &subheight);
+    elems_[i].elem_->render(display, x0, y0 + *height, targetWidth,
+                            subTargetHeight, &subwidth, &subheight);
     *height += subheight;
     if (subwidth > *width) {
       *width = subwidth;
@@ -268,7 +464,7 @@ void LayoutRows::draw(Display *display, int16_t x0, int16_t y0,
 void LayoutCenter::size(Display *display, uint16_t targetWidth,
                         uint16_t targetHeight, uint16_t *width,
                         uint16_t *height) {
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
   if (*width < targetWidth) {
     *width = targetWidth;
   }
@@ -282,7 +478,7 @@ void LayoutCenter::draw(Display *display, int16_t x0, int16_t y0,
                         uint16_t *width, uint16_t *height) {
   int16_t x0_offset = 0, y0_offset = 0;
 
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
   if (*width < targetWidth) {
     x0_offset = (targetWidth - *width) / 2;
   }
@@ -290,8 +486,8 @@ void LayoutCenter::draw(Display *display, int16_t x0, int16_t y0,
     y0_offset = (targetHeight - *height) / 2;
   }
 
-  child_->draw(display, x0 + x0_offset, y0 + y0_offset, *width, *height, width,
-               height);
+  child_->render(display, x0 + x0_offset, y0 + y0_offset, *width, *height,
+                 width, height);
 
   *width += x0_offset;
   *height += y0_offset;
@@ -306,7 +502,7 @@ void LayoutCenter::draw(Display *display, int16_t x0, int16_t y0,
 void LayoutHCenter::size(Display *display, uint16_t targetWidth,
                          uint16_t targetHeight, uint16_t *width,
                          uint16_t *height) {
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
   if (*width < targetWidth) {
     *width = targetWidth;
   }
@@ -317,12 +513,12 @@ void LayoutHCenter::draw(Display *display, int16_t x0, int16_t y0,
                          uint16_t *width, uint16_t *height) {
   int16_t x0_offset = 0;
 
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
   if (*width < targetWidth) {
     x0_offset = (targetWidth - *width) / 2;
   }
 
-  child_->draw(display, x0 + x0_offset, y0, *width, *height, width, height);
+  child_->render(display, x0 + x0_offset, y0, *width, *height, width, height);
 
   *width += x0_offset;
   if (*width < targetWidth) {
@@ -333,7 +529,7 @@ void LayoutHCenter::draw(Display *display, int16_t x0, int16_t y0,
 void LayoutVCenter::size(Display *display, uint16_t targetWidth,
                          uint16_t targetHeight, uint16_t *width,
                          uint16_t *height) {
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
   if (*height < targetHeight) {
     *height = targetHeight;
   }
@@ -344,12 +540,12 @@ void LayoutVCenter::draw(Display *display, int16_t x0, int16_t y0,
                          uint16_t *width, uint16_t *height) {
   int16_t y0_offset = 0;
 
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
   if (*height < targetHeight) {
     y0_offset = (targetHeight - *height) / 2;
   }
 
-  child_->draw(display, x0, y0 + y0_offset, *width, *height, width, height);
+  child_->render(display, x0, y0 + y0_offset, *width, *height, width, height);
 
   *height += y0_offset;
   if (*height < targetHeight) {
@@ -359,8 +555,8 @@ void LayoutVCenter::draw(Display *display, int16_t x0, int16_t y0,
 
 LayoutPad::LayoutPad(const LayoutElement &child, int16_t padTop,
                      int16_t padRight, int16_t padBottom, int16_t padLeft)
-    : child_(child.clone()), padTop_(padTop), padRight_(padRight),
-      padBottom_(padBottom), padLeft_(padLeft) {}
+    : LayoutElement(LAYOUT_STABLE), child_(child.clone()), padTop_(padTop),
+      padRight_(padRight), padBottom_(padBottom), padLeft_(padLeft) {}
 
 void LayoutPad::size(Display *display, uint16_t targetWidth,
                      uint16_t targetHeight, uint16_t *width, uint16_t *height) {
@@ -370,7 +566,7 @@ void LayoutPad::size(Display *display, uint16_t targetWidth,
   signedTargetHeight -= (padTop_ + padBottom_);
   targetWidth  = (signedTargetWidth < 0) ? 0 : (uint16_t)signedTargetWidth;
   targetHeight = (signedTargetHeight < 0) ? 0 : (uint16_t)signedTargetHeight;
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
   *width += padLeft_ + padRight_;
   *height += padTop_ + padBottom_;
 }
@@ -384,27 +580,28 @@ void LayoutPad::draw(Display *display, int16_t x0, int16_t y0,
   signedTargetHeight -= (padTop_ + padBottom_);
   targetWidth  = (signedTargetWidth < 0) ? 0 : (uint16_t)signedTargetWidth;
   targetHeight = (signedTargetHeight < 0) ? 0 : (uint16_t)signedTargetHeight;
-  child_->draw(display, x0 + padLeft_, y0 + padTop_, targetWidth, targetHeight,
-               width, height);
+  child_->render(display, x0 + padLeft_, y0 + padTop_, targetWidth,
+                 targetHeight, width, height);
   *width += padLeft_ + padRight_;
   *height += padTop_ + padBottom_;
 }
 
 LayoutBorder::LayoutBorder(const LayoutElement &child, bool top, bool right,
                            bool bottom, bool left, uint16_t color)
-    : pad_(child, top ? 1 : 0, right ? 1 : 0, bottom ? 1 : 0, left ? 1 : 0),
+    : LayoutElement(LAYOUT_STABLE),
+      pad_(child, top ? 1 : 0, right ? 1 : 0, bottom ? 1 : 0, left ? 1 : 0),
       color_(color) {}
 
 void LayoutBorder::size(Display *display, uint16_t targetWidth,
                         uint16_t targetHeight, uint16_t *width,
                         uint16_t *height) {
-  pad_.size(display, targetWidth, targetHeight, width, height);
+  pad_.measure(display, targetWidth, targetHeight, width, height);
 }
 
 void LayoutBorder::draw(Display *display, int16_t x0, int16_t y0,
                         uint16_t targetWidth, uint16_t targetHeight,
                         uint16_t *width, uint16_t *height) {
-  pad_.draw(display, x0, y0, targetWidth, targetHeight, width, height);
+  pad_.render(display, x0, y0, targetWidth, targetHeight, width, height);
   if (pad_.padTop() > 0) {
     display->drawFastHLine(x0, y0, *width, color_);
   }
@@ -422,29 +619,29 @@ void LayoutBorder::draw(Display *display, int16_t x0, int16_t y0,
 void LayoutBackground::size(Display *display, uint16_t targetWidth,
                             uint16_t targetHeight, uint16_t *width,
                             uint16_t *height) {
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
 }
 
 void LayoutBackground::draw(Display *display, int16_t x0, int16_t y0,
                             uint16_t targetWidth, uint16_t targetHeight,
                             uint16_t *width, uint16_t *height) {
-  child_->size(display, targetWidth, targetHeight, width, height);
+  child_->measure(display, targetWidth, targetHeight, width, height);
   display->fillRect(x0, y0, *width, *height, color_);
-  child_->draw(display, x0, y0, targetWidth, targetHeight, width, height);
+  child_->render(display, x0, y0, targetWidth, targetHeight, width, height);
 }
 
 void LayoutOverlay::size(Display *display, uint16_t targetWidth,
                          uint16_t targetHeight, uint16_t *width,
                          uint16_t *height) {
   uint16_t w, h;
-  background_->size(display, targetWidth, targetHeight, &w, &h);
+  background_->measure(display, targetWidth, targetHeight, &w, &h);
   if (targetWidth < w) {
     targetWidth = w;
   }
   if (targetHeight < h) {
     targetHeight = h;
   }
-  foreground_->size(display, targetWidth, targetHeight, width, height);
+  foreground_->measure(display, targetWidth, targetHeight, width, height);
   if (w > *width) {
     *width = w;
   }
@@ -456,12 +653,14 @@ void LayoutOverlay::size(Display *display, uint16_t targetWidth,
 void LayoutOverlay::draw(Display *display, int16_t x0, int16_t y0,
                          uint16_t targetWidth, uint16_t targetHeight,
                          uint16_t *width, uint16_t *height) {
-  background_->draw(display, x0, y0, targetWidth, targetHeight, width, height);
+  background_->render(display, x0, y0, targetWidth, targetHeight, width,
+                      height);
   if (targetWidth < *width) {
     targetWidth = *width;
   }
   if (targetHeight < *height) {
     targetHeight = *height;
   }
-  foreground_->draw(display, x0, y0, targetWidth, targetHeight, width, height);
+  foreground_->render(display, x0, y0, targetWidth, targetHeight, width,
+                      height);
 }
@@ -6,12 +6,87 @@
 #include <vector>
 #include <initializer_list>
 
+// LayoutStats counts how much work the layout engine has done since the last
+// LayoutElement::startFrame(). measureCalls is how many times a parent asked a
+// child for its size, and sizeCalls is how many of those actually had to run
+// the child's size() because the answer wasn't already known. drawCalls is how
+// many times a parent drew a child.
+typedef struct LayoutStats {
+  uint32_t measureCalls;
+  uint32_t sizeCalls;
+  uint32_t drawCalls;
+} LayoutStats;
+
+extern LayoutStats layoutStats;
+
+// LayoutRect is a rectangle in unrotated display coordinates.
+typedef struct LayoutRect {
+  int16_t x;
+  int16_t y;
+  uint16_t width;
+  uint16_t height;
+} LayoutRect;
+
+// layoutDamage is the part of the display that may look different than it did
+// in the previous frame. Everything outside of it is the same. Every
+// LayoutElement::startFrame() and startOverlay() set it to the whole display,
+// and only LayoutElement::redraw() makes it smaller. It is empty if the width
+// or height is 0.
+extern LayoutRect layoutDamage;
+
+// LayoutDependencies says what a LayoutElement's size and appearance depend
+// on, which decides how much measure() and redraw() can skip.
+typedef enum LayoutDependencies {
+  // anything at all, such as the time or a sensor. It's measured again every
+  // frame and always counts as changed.
+  LAYOUT_VOLATILE = 0,
+  // only its own fields, the space it's given, and its children.
+  LAYOUT_STABLE = 1,
+  // only its own fields. Its measurement is kept until it changes.
+  LAYOUT_SELF_CONTAINED = 2,
+} LayoutDependencies;
+
+class LayoutElement;
+
+// LayoutElementPtr is a reference counted handle to a LayoutElement, like a
+// std::shared_ptr, but the count lives in the element itself and is not
+// atomic, since layout only happens on one thread. The element must have been
+// allocated with new, which for LayoutElements means globalArena, and it is
+// destroyed when the last handle goes away. When globalArena has run out, new
+// gives NULL, and the handle points at an empty element instead so the rest of
+// the view still draws.
+class LayoutElementPtr {
+public:
+  LayoutElementPtr() : elem_(NULL) {}
+  explicit LayoutElementPtr(LayoutElement *elem);
+  LayoutElementPtr(const LayoutElementPtr &copy);
+  LayoutElementPtr(LayoutElementPtr &&move) noexcept : elem_(move.elem_) {
+    move.elem_ = NULL;
+  }
+  ~LayoutElementPtr();
+
+  LayoutElementPtr &operator=(LayoutElementPtr copy) noexcept {
+    LayoutElement *swap = elem_;
+    elem_               = copy.elem_;
+    copy.elem_          = swap;
+    return *this;
+  }
+
+  LayoutElement *get() const { return elem_; }
+  LayoutElement *operator->() const { return elem_; }
+  LayoutElement &operator*() const { return *elem_; }
+  explicit operator bool() const { return elem_ != NULL; }
+
+private:
+  LayoutElement *elem_;
+};
+
 // This is the base class for a LayoutElement. You can compose a whole view
 // in terms of a hierarchy of LayoutElements, which will then align and orient
 // themselves as their parents request.
 class LayoutElement {
 public:
-  typedef std::shared_ptr<LayoutElement> ptr;
+  typedef LayoutElementPtr ptr;
 
 public:
   // Every LayoutElement must implement size(). size() is given a targetWidth
@@ -35,35 +110,129 @@ public:
                     uint16_t *width, uint16_t *height) = 0;
 
   // Every LayoutElement must implement clone, which should return a
-  // std::shared_ptr of the concrete descendent type. See some concrete
+  // LayoutElement::ptr to a new copy of the concrete descendent type, e.g.
+  // LayoutElement::ptr(new LayoutBitmap(*this)). See some concrete
   // LayoutElements for examples.
   virtual LayoutElement::ptr clone() const = 0;
 
-  // virtual destructor and arena memory management
+  // measure() returns the same thing as size(), but remembers the answer for
+  // the given targetWidth and targetHeight until the next startFrame(), or for
+  // self-contained elements, until they change. Parent elements should call
+  // measure() on their children instead of size(), otherwise nested
+  // containers end up measuring the same subtree over and over again.
+  void measure(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+               uint16_t *width, uint16_t *height);
+
+  // render() draws this element with draw(). Parent elements should call
+  // render() on their children instead of draw() so that layoutStats and
+  // layoutDamage can account for it.
+  void render(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+              uint16_t targetHeight, uint16_t *width, uint16_t *height);
+
+  // redraw() is render() for the root of a layout tree that an App keeps from
+  // frame to frame. If the previous frame was a redraw() of the same tree,
+  // layoutDamage is narrowed down to where elements that changed were and now
+  // are, plus wherever overlays have drawn since. This is only right if
+  // nothing but the tree and overlays draws on the display and every element
+  // in it is drawn every frame, so Apps that draw anything else themselves
+  // should use render().
+  void redraw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+              uint16_t targetHeight, uint16_t *width, uint16_t *height);
+
+  // startFrame() forgets what measure() has remembered for everything but
+  // self-contained elements, resets layoutStats, and sets layoutDamage to the
+  // whole display. It should be called before each new frame is drawn, as
+  // element sizes may depend on state that has since changed.
+  static void startFrame();
+  // startOverlay() is startFrame() for something drawn over the top of the
+  // last frame without replacing it, such as a notice. The next redraw() of
+  // the tree that drew the last frame can still narrow layoutDamage down, as
+  // long as what the overlay drew is passed to overlaid() so it's included.
+  static void startOverlay();
+  static void overlaid(Display *display, int16_t x, int16_t y, uint16_t width,
+                       uint16_t height);
+
+  // virtual destructor and arena memory management. new returns NULL rather
+  // than throwing when globalArena has run out.
   virtual ~LayoutElement() = default;
-  static void *operator new(size_t size);
-  static void *operator new[](size_t size);
+  static void *operator new(size_t size) noexcept;
+  static void *operator new[](size_t size) noexcept;
   static void operator delete(void *ptr, size_t size) noexcept;
   static void operator delete(void *ptr) noexcept;
   static void operator delete[](void *ptr, size_t size) noexcept;
   static void operator delete[](void *ptr) noexcept;
 
 protected:
-  LayoutElement()                                 = default;
+  // elements are LAYOUT_VOLATILE unless they say otherwise. Elements that
+  // aren't must call forgetMeasurement() whenever their fields change.
+  explicit LayoutElement(LayoutDependencies depends = LAYOUT_VOLATILE)
+      : refs_(0), depends_(depends), changed_(false), drawn_(false),
+        measuredFrame_(0) {}
   LayoutElement(const LayoutElement &)            = delete;
   LayoutElement &operator=(const LayoutElement &) = delete;
   LayoutElement(LayoutElement &&)                 = delete;
   LayoutElement &operator=(LayoutElement &&)      = delete;
+
+  // mutable elements should call forgetMeasurement() when they change in a
+  // way that affects their size or appearance.
+  void forgetMeasurement() {
+    measuredFrame_ = 0;
+    changed_       = true;
+  }
+
+private:
+  friend class LayoutElementPtr;
+  // missing() is the empty element that stands in for one new couldn't make.
+  static LayoutElement *missing();
+
+  uint16_t refs_;
+  uint8_t depends_;
+  bool changed_;
+  bool drawn_;
+  LayoutRect drawnRect_;
+
+  static const LayoutElement *frameRoot_;
+  static const LayoutElement *previousRoot_;
+  static bool trackDamage_;
+  // overlayDamage_ is where overlays have drawn since the last redraw().
+  static LayoutRect overlayDamage_;
+
+  static uint16_t frame_;
+  uint16_t measuredFrame_;
+  uint16_t measuredTargetWidth_, measuredTargetHeight_;
+  uint16_t measuredWidth_, measuredHeight_;
 };
 
+inline LayoutElementPtr::LayoutElementPtr(LayoutElement *elem) : elem_(elem) {
+  if (!elem_) {
+    elem_ = LayoutElement::missing();
+  }
+  elem_->refs_++;
+}
+
+inline LayoutElementPtr::LayoutElementPtr(const LayoutElementPtr &copy)
+    : elem_(copy.elem_) {
+  if (elem_) {
+    elem_->refs_++;
+  }
+}
+
+inline LayoutElementPtr::~LayoutElementPtr() {
+  if (elem_ && --elem_->refs_ == 0) {
+    delete elem_;
+  }
+}
+
 // LayoutBitmap takes a pointer to an array of bytes representing a bitmap,
 // and the width and height of that bitmap.
 class LayoutBitmap : public LayoutElement {
 public:
   LayoutBitmap(const uint8_t *bitmap, uint16_t w, uint16_t h, uint16_t color)
-      : bitmap_(bitmap), w_(w), h_(h), color_(color) {}
+      : LayoutElement(LAYOUT_SELF_CONTAINED), bitmap_(bitmap), w_(w), h_(h),
+        color_(color) {}
   LayoutBitmap(const LayoutBitmap &copy)
-      : bitmap_(copy.bitmap_), w_(copy.w_), h_(copy.h_), color_(copy.color_) {}
+      : LayoutElement(LAYOUT_SELF_CONTAINED), bitmap_(copy.bitmap_),
+        w_(copy.w_), h_(copy.h_), color_(copy.color_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override {
@@ -79,7 +248,7 @@ public:
   }
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutBitmap>(*this);
+    return LayoutElement::ptr(new LayoutBitmap(*this));
   }
 
 private:
@@ -88,13 +257,24 @@ private:
   uint16_t color_;
 };
 
-// LayoutText takes a string, a font, and a color.
+// LayoutText takes a string, a font, and a color. The text can be changed
+// later with setText().
 class LayoutText : public LayoutElement {
 public:
   LayoutText(String text, const GFXfont *font, uint16_t color)
-      : text_(text), font_(font), color_(color) {}
+      : LayoutElement(LAYOUT_SELF_CONTAINED), text_(text), font_(font),
+        color_(color) {}
   LayoutText(const LayoutText &copy)
-      : text_(copy.text_), font_(copy.font_), color_(copy.color_) {}
+      : LayoutElement(LAYOUT_SELF_CONTAINED), text_(copy.text_),
+        font_(copy.font_), color_(copy.color_) {}
+
+  const String &text() const { return text_; }
+  void setText(const String &text) {
+    if (text != text_) {
+      text_ = text;
+      forgetMeasurement();
+    }
+  }
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -102,7 +282,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutText>(*this);
+    return LayoutElement::ptr(new LayoutText(*this));
   }
 
 private:
@@ -138,8 +318,9 @@ class LayoutColumns : public LayoutElement {
 public:
   LayoutColumns(std::initializer_list<LayoutEntry> elems);
   LayoutColumns(std::vector<LayoutEntry, MemArenaAllocator<LayoutEntry>> elems)
-      : elems_(std::move(elems)) {}
-  LayoutColumns(const LayoutColumns &copy) : elems_(copy.elems_) {}
+      : LayoutElement(LAYOUT_STABLE), elems_(std::move(elems)) {}
+  LayoutColumns(const LayoutColumns &copy)
+      : LayoutElement(LAYOUT_STABLE), elems_(copy.elems_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -147,7 +328,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutColumns>(*this);
+    return LayoutElement::ptr(new LayoutColumns(*this));
   }
 
 private:
@@ -160,8 +341,9 @@ class LayoutRows : public LayoutElement {
 public:
   LayoutRows(std::initializer_list<LayoutEntry> elems);
   LayoutRows(std::vector<LayoutEntry, MemArenaAllocator<LayoutEntry>> elems)
-      : elems_(std::move(elems)) {}
-  LayoutRows(const LayoutRows &copy) : elems_(copy.elems_) {}
+      : LayoutElement(LAYOUT_STABLE), elems_(std::move(elems)) {}
+  LayoutRows(const LayoutRows &copy)
+      : LayoutElement(LAYOUT_STABLE), elems_(copy.elems_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -169,7 +351,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutRows>(*this);
+    return LayoutElement::ptr(new LayoutRows(*this));
   }
 
 private:
@@ -181,6 +363,8 @@ private:
 // LayoutColumns.
 class LayoutFill : public LayoutElement {
 public:
+  LayoutFill() : LayoutElement(LAYOUT_STABLE) {}
+
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override {
     *width  = targetWidth;
@@ -194,7 +378,7 @@ public:
   }
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutFill>();
+    return LayoutElement::ptr(new LayoutFill());
   }
 };
 
@@ -202,8 +386,10 @@ public:
 // horizontally, within the available space.
 class LayoutCenter : public LayoutElement {
 public:
-  explicit LayoutCenter(const LayoutElement &child) : child_(child.clone()) {}
-  LayoutCenter(const LayoutCenter &copy) : child_(copy.child_) {}
+  explicit LayoutCenter(const LayoutElement &child)
+      : LayoutElement(LAYOUT_STABLE), child_(child.clone()) {}
+  LayoutCenter(const LayoutCenter &copy)
+      : LayoutElement(LAYOUT_STABLE), child_(copy.child_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -211,7 +397,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutCenter>(*this);
+    return LayoutElement::ptr(new LayoutCenter(*this));
   }
 
 private:
@@ -222,8 +408,10 @@ private:
 // available space.
 class LayoutHCenter : public LayoutElement {
 public:
-  explicit LayoutHCenter(const LayoutElement &child) : child_(child.clone()) {}
-  LayoutHCenter(const LayoutHCenter &copy) : child_(copy.child_) {}
+  explicit LayoutHCenter(const LayoutElement &child)
+      : LayoutElement(LAYOUT_STABLE), child_(child.clone()) {}
+  LayoutHCenter(const LayoutHCenter &copy)
+      : LayoutElement(LAYOUT_STABLE), child_(copy.child_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -231,7 +419,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutHCenter>(*this);
+    return LayoutElement::ptr(new LayoutHCenter(*this));
   }
 
 private:
@@ -242,8 +430,10 @@ private:
 // available space.
 class LayoutVCenter : public LayoutElement {
 public:
-  explicit LayoutVCenter(const LayoutElement &child) : child_(child.clone()) {}
-  LayoutVCenter(const LayoutVCenter &copy) : child_(copy.child_) {}
+  explicit LayoutVCenter(const LayoutElement &child)
+      : LayoutElement(LAYOUT_STABLE), child_(child.clone()) {}
+  LayoutVCenter(const LayoutVCenter &copy)
+      : LayoutElement(LAYOUT_STABLE), child_(copy.child_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -251,7 +441,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutVCenter>(*this);
+    return LayoutElement::ptr(new LayoutVCenter(*this));
   }
 
 private:
@@ -265,7 +455,8 @@ public:
   LayoutPad(const LayoutElement &child, int16_t padTop, int16_t padRight,
             int16_t padBottom, int16_t padLeft);
   LayoutPad(const LayoutPad &copy)
-      : child_(copy.child_), padTop_(copy.padTop_), padRight_(copy.padRight_),
+      : LayoutElement(LAYOUT_STABLE), child_(copy.child_),
+        padTop_(copy.padTop_), padRight_(copy.padRight_),
         padBottom_(copy.padBottom_), padLeft_(copy.padLeft_) {}
 
   int16_t padTop() { return padTop_; }
@@ -280,7 +471,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutPad>(*this);
+    return LayoutElement::ptr(new LayoutPad(*this));
   }
 
 private:
@@ -296,8 +487,10 @@ private:
 // or LayoutColumns.
 class LayoutSpacer : public LayoutElement {
 public:
-  LayoutSpacer(const LayoutSpacer &copy) : size_(copy.size_) {}
-  explicit LayoutSpacer(uint16_t spacerSize) : size_(spacerSize) {}
+  LayoutSpacer(const LayoutSpacer &copy)
+      : LayoutElement(LAYOUT_SELF_CONTAINED), size_(copy.size_) {}
+  explicit LayoutSpacer(uint16_t spacerSize)
+      : LayoutElement(LAYOUT_SELF_CONTAINED), size_(spacerSize) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override {
@@ -312,7 +505,7 @@ public:
   }
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutSpacer>(*this);
+    return LayoutElement::ptr(new LayoutSpacer(*this));
   }
 
 private:
@@ -324,9 +517,10 @@ private:
 class LayoutRotate : public LayoutElement {
 public:
   LayoutRotate(const LayoutElement &child, uint8_t rotate)
-      : child_(child.clone()), rotate_(rotate) {}
+      : LayoutElement(LAYOUT_STABLE), child_(child.clone()), rotate_(rotate) {}
   LayoutRotate(const LayoutRotate &copy)
-      : child_(copy.child_), rotate_(copy.rotate_) {}
+      : LayoutElement(LAYOUT_STABLE), child_(copy.child_),
+        rotate_(copy.rotate_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -335,7 +529,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutRotate>(*this);
+    return LayoutElement::ptr(new LayoutRotate(*this));
   }
 
 private:
@@ -350,7 +544,7 @@ public:
   LayoutBorder(const LayoutElement &child, bool top, bool right, bool bottom,
                bool left, uint16_t color);
   LayoutBorder(const LayoutBorder &copy)
-      : pad_(copy.pad_), color_(copy.color_) {}
+      : LayoutElement(LAYOUT_STABLE), pad_(copy.pad_), color_(copy.color_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -359,7 +553,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutBorder>(*this);
+    return LayoutElement::ptr(new LayoutBorder(*this));
   }
 
 private:
@@ -371,9 +565,10 @@ private:
 class LayoutBackground : public LayoutElement {
 public:
   LayoutBackground(const LayoutElement &child, uint16_t color)
-      : child_(child.clone()), color_(color) {}
+      : LayoutElement(LAYOUT_STABLE), child_(child.clone()), color_(color) {}
   LayoutBackground(const LayoutBackground &copy)
-      : child_(copy.child_), color_(copy.color_) {}
+      : LayoutElement(LAYOUT_STABLE), child_(copy.child_),
+        color_(copy.color_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -382,7 +577,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutBackground>(*this);
+    return LayoutElement::ptr(new LayoutBackground(*this));
   }
 
 private:
@@ -396,9 +591,11 @@ class LayoutOverlay : public LayoutElement {
 public:
   LayoutOverlay(const LayoutElement &background,
                 const LayoutElement &foreground)
-      : background_(background.clone()), foreground_(foreground.clone()) {}
+      : LayoutElement(LAYOUT_STABLE), background_(background.clone()),
+        foreground_(foreground.clone()) {}
   LayoutOverlay(const LayoutOverlay &copy)
-      : background_(copy.background_), foreground_(copy.foreground_) {}
+      : LayoutElement(LAYOUT_STABLE), background_(copy.background_),
+        foreground_(copy.foreground_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override;
@@ -407,7 +604,7 @@ public:
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override;
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutOverlay>(*this);
+    return LayoutElement::ptr(new LayoutOverlay(*this));
   }
 
 private:
@@ -420,12 +617,13 @@ private:
 class LayoutRightAlign : public LayoutElement {
 public:
   explicit LayoutRightAlign(const LayoutElement &child)
-      : child_(child.clone()) {}
-  LayoutRightAlign(const LayoutRightAlign &copy) : child_(copy.child_) {}
+      : LayoutElement(LAYOUT_STABLE), child_(child.clone()) {}
+  LayoutRightAlign(const LayoutRightAlign &copy)
+      : LayoutElement(LAYOUT_STABLE), child_(copy.child_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override {
-    child_->size(display, targetWidth, targetHeight, width, height);
+    child_->measure(display, targetWidth, targetHeight, width, height);
     if (*width < targetWidth) {
       *width = targetWidth;
     }
@@ -433,18 +631,18 @@ public:
 
   void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override {
-    child_->size(display, targetWidth, targetHeight, width, height);
+    child_->measure(display, targetWidth, targetHeight, width, height);
     int16_t adjustment = 0;
     if (*width < targetWidth) {
       adjustment = targetWidth - *width;
     }
-    child_->draw(display, x0 + adjustment, y0, targetWidth - adjustment,
-                 targetHeight, width, height);
+    child_->render(display, x0 + adjustment, y0, targetWidth - adjustment,
+                   targetHeight, width, height);
     *width += adjustment;
   }
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutRightAlign>(*this);
+    return LayoutElement::ptr(new LayoutRightAlign(*this));
   }
 
 private:
@@ -456,12 +654,13 @@ private:
 class LayoutBottomAlign : public LayoutElement {
 public:
   explicit LayoutBottomAlign(const LayoutElement &child)
-      : child_(child.clone()) {}
-  LayoutBottomAlign(const LayoutBottomAlign &copy) : child_(copy.child_) {}
+      : LayoutElement(LAYOUT_STABLE), child_(child.clone()) {}
+  LayoutBottomAlign(const LayoutBottomAlign &copy)
+      : LayoutElement(LAYOUT_STABLE), child_(copy.child_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override {
-    child_->size(display, targetWidth, targetHeight, width, height);
+    child_->measure(display, targetWidth, targetHeight, width, height);
     if (*height < targetHeight) {
       *height = targetHeight;
     }
@@ -469,18 +668,18 @@ public:
 
   void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
             uint16_t targetHeight, uint16_t *width, uint16_t *height) override {
-    child_->size(display, targetWidth, targetHeight, width, height);
+    child_->measure(display, targetWidth, targetHeight, width, height);
     int16_t adjustment = 0;
     if (*height < targetHeight) {
       adjustment = targetHeight - *height;
     }
-    child_->draw(display, x0, y0 + adjustment, targetWidth,
-                 targetHeight - adjustment, width, height);
+    child_->render(display, x0, y0 + adjustment, targetWidth,
+                   targetHeight - adjustment, width, height);
     *height += adjustment;
   }
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutBottomAlign>(*this);
+    return LayoutElement::ptr(new LayoutBottomAlign(*this));
   }
 
 private:
@@ -493,9 +692,11 @@ private:
 // LayoutCell's notable method is set().
 class LayoutCell : public LayoutElement {
 public:
-  LayoutCell() : child_() {}
-  explicit LayoutCell(const LayoutElement &child) : child_(child.clone()) {}
-  LayoutCell(const LayoutCell &copy) : child_(copy.child_) {}
+  LayoutCell() : LayoutElement(LAYOUT_STABLE), child_() {}
+  explicit LayoutCell(const LayoutElement &child)
+      : LayoutElement(LAYOUT_STABLE), child_(child.clone()) {}
+  LayoutCell(const LayoutCell &copy)
+      : LayoutElement(LAYOUT_STABLE), child_(copy.child_) {}
 
   void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
             uint16_t *width, uint16_t *height) override {
@@ -504,7 +705,7 @@ public:
       *height = 0;
       return;
     }
-    child_->size(display, targetWidth, targetHeight, width, height);
+    child_->measure(display, targetWidth, targetHeight, width, height);
   }
 
   void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
@@ -514,15 +715,55 @@ public:
       *height = 0;
       return;
     }
-    child_->draw(display, x0, y0, targetWidth, targetHeight, width, height);
+    child_->render(display, x0, y0, targetWidth, targetHeight, width, height);
   }
 
-  void set(const LayoutElement &child) { child_ = child.clone(); }
+  void set(const LayoutElement &child) {
+    child_ = child.clone();
+    forgetMeasurement();
+  }
 
   LayoutElement::ptr clone() const override {
-    return std::make_shared<LayoutCell>(*this);
+    return LayoutElement::ptr(new LayoutCell(*this));
   }
 
 private:
   LayoutElement::ptr child_;
 };
+
+// LayoutRef keeps a handle on an element after it has been placed in a tree,
+// so that a tree can be built once and then updated in place instead of being
+// rebuilt for every frame. Containers clone their children, and cloning a
+// LayoutRef returns the element it refers to instead of a copy (the same trick
+// LayoutButtonLabels uses).
+//
+//     LayoutRef<LayoutText> clock(LayoutText("12:00", font, color));
+//     LayoutElement::ptr root = LayoutCenter(clock).clone();
+//     ...
+//     clock->setText("12:01");
+template <typename T> class LayoutRef : public LayoutElement {
+public:
+  explicit LayoutRef(const T &elem)
+      : LayoutElement(LAYOUT_STABLE), elem_(new T(elem)), ptr_(elem_) {}
+  LayoutRef(const LayoutRef &copy)
+      : LayoutElement(LAYOUT_STABLE), elem_(copy.elem_), ptr_(copy.ptr_) {}
+
+  T *get() const { return elem_; }
+  T *operator->() const { return elem_; }
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) override {
+    elem_->measure(display, targetWidth, targetHeight, width, height);
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) override {
+    elem_->render(display, x0, y0, targetWidth, targetHeight, width, height);
+  }
+
+  LayoutElement::ptr clone() const override { return ptr_; }
+
+private:
+  T *elem_;
+  LayoutElement::ptr ptr_;
+};
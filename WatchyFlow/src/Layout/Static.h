@@ -0,0 +1,576 @@
+#pragma once
+
+#include "Layout.h"
+#include "TextMetrics.h"
+
+// Static layouts are for screens whose shape never changes, only the values
+// in it. Where a LayoutRows holds a vector of cloned, arena allocated children
+// and calls them through virtual functions, a StaticRows<A, B, C> holds an A,
+// a B and a C by value and calls them directly, so the whole tree is one
+// value on the stack whose structure the compiler can see and inline.
+//
+// The static types mirror the LayoutElements of the same name and size and
+// draw exactly the same way, but they are not LayoutElements: they don't
+// remember measurements, count layoutStats, or track damage. LayoutStatic
+// puts a static tree inside a regular layout tree, and StaticElement puts a
+// regular element inside a static tree.
+//
+// Since C++11 can't deduce class template arguments, the trees are built with
+// the lowercase helper functions:
+//
+//     staticVCenter(staticRows(
+//         staticHCenter(staticText(time.c_str(), &font, color)),
+//         staticSpacer(5),
+//         staticStretch(staticFill())))
+//
+// StaticText only points at its text, which has to outlive the tree.
+
+// StaticText draws text in the provided font, like LayoutText.
+class StaticText {
+public:
+  static const bool stretch = false;
+
+  StaticText(const char *text, const GFXfont *font, uint16_t color)
+      : text_(text), font_(font), color_(color) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) {
+    int16_t x1, y1;
+    bounds(display, &x1, &y1, width, height);
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) {
+    int16_t x1, y1;
+    bounds(display, &x1, &y1, width, height);
+    if (*width == 0 && *height == 0) {
+      return;
+    }
+    display->setTextColor(color_);
+    display->setCursor(x0 - x1, y0 - y1);
+    display->print(text_);
+  }
+
+private:
+  void bounds(Display *display, int16_t *x1, int16_t *y1, uint16_t *width,
+              uint16_t *height) {
+    if (!text_ || !text_[0]) {
+      *width  = 0;
+      *height = 0;
+      return;
+    }
+    textBounds(display, font_, text_, x1, y1, width, height);
+  }
+
+  const char *text_;
+  const GFXfont *font_;
+  uint16_t color_;
+};
+
+// StaticSpacer takes up a small square of the given size, like LayoutSpacer.
+class StaticSpacer {
+public:
+  static const bool stretch = false;
+
+  explicit StaticSpacer(uint16_t spacerSize) : size_(spacerSize) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) {
+    *width  = size_;
+    *height = size_;
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) {
+    *width  = size_;
+    *height = size_;
+  }
+
+private:
+  uint16_t size_;
+};
+
+// StaticFill takes whatever space it is given, like LayoutFill.
+class StaticFill {
+public:
+  static const bool stretch = false;
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) {
+    *width  = targetWidth;
+    *height = targetHeight;
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) {
+    *width  = targetWidth;
+    *height = targetHeight;
+  }
+};
+
+// StaticStretch marks a cell of StaticRows or StaticColumns to be stretched,
+// like LayoutEntry's stretch argument.
+template <class T> class StaticStretch : public T {
+public:
+  static const bool stretch = true;
+
+  explicit StaticStretch(const T &child) : T(child) {}
+};
+
+// StaticElement draws a regular LayoutElement inside a static tree.
+class StaticElement {
+public:
+  static const bool stretch = false;
+
+  explicit StaticElement(LayoutElement &elem) : elem_(&elem) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) {
+    elem_->measure(display, targetWidth, targetHeight, width, height);
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) {
+    elem_->render(display, x0, y0, targetWidth, targetHeight, width, height);
+  }
+
+private:
+  LayoutElement *elem_;
+};
+
+// StaticPad pads its child, like LayoutPad.
+template <class T> class StaticPad {
+public:
+  static const bool stretch = false;
+
+  StaticPad(const T &child, int16_t padTop, int16_t padRight,
+            int16_t padBottom, int16_t padLeft)
+      : child_(child), padTop_(padTop), padRight_(padRight),
+        padBottom_(padBottom), padLeft_(padLeft) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) {
+    child_.size(display, inner(targetWidth, padLeft_ + padRight_),
+                inner(targetHeight, padTop_ + padBottom_), width, height);
+    *width += padLeft_ + padRight_;
+    *height += padTop_ + padBottom_;
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) {
+    child_.draw(display, x0 + padLeft_, y0 + padTop_,
+                inner(targetWidth, padLeft_ + padRight_),
+                inner(targetHeight, padTop_ + padBottom_), width, height);
+    *width += padLeft_ + padRight_;
+    *height += padTop_ + padBottom_;
+  }
+
+private:
+  static uint16_t inner(uint16_t target, int16_t pad) {
+    int16_t signedTarget = (int16_t)target - pad;
+    return signedTarget < 0 ? 0 : (uint16_t)signedTarget;
+  }
+
+  T child_;
+  int16_t padTop_;
+  int16_t padRight_;
+  int16_t padBottom_;
+  int16_t padLeft_;
+};
+
+// StaticHCenter horizontally centers its child, like LayoutHCenter.
+template <class T> class StaticHCenter {
+public:
+  static const bool stretch = false;
+
+  explicit StaticHCenter(const T &child) : child_(child) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) {
+    child_.size(display, targetWidth, targetHeight, width, height);
+    if (*width < targetWidth) {
+      *width = targetWidth;
+    }
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) {
+    int16_t x0_offset = 0;
+    child_.size(display, targetWidth, targetHeight, width, height);
+    if (*width < targetWidth) {
+      x0_offset = (targetWidth - *width) / 2;
+    }
+    child_.draw(display, x0 + x0_offset, y0, *width, *height, width, height);
+    *width += x0_offset;
+    if (*width < targetWidth) {
+      *width = targetWidth;
+    }
+  }
+
+private:
+  T child_;
+};
+
+// StaticVCenter vertically centers its child, like LayoutVCenter.
+template <class T> class StaticVCenter {
+public:
+  static const bool stretch = false;
+
+  explicit StaticVCenter(const T &child) : child_(child) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) {
+    child_.size(display, targetWidth, targetHeight, width, height);
+    if (*height < targetHeight) {
+      *height = targetHeight;
+    }
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) {
+    int16_t y0_offset = 0;
+    child_.size(display, targetWidth, targetHeight, width, height);
+    if (*height < targetHeight) {
+      y0_offset = (targetHeight - *height) / 2;
+    }
+    child_.draw(display, x0, y0 + y0_offset, *width, *height, width, height);
+    *height += y0_offset;
+    if (*height < targetHeight) {
+      *height = targetHeight;
+    }
+  }
+
+private:
+  T child_;
+};
+
+// StaticCenter centers its child both ways, like LayoutCenter.
+template <class T> class StaticCenter {
+public:
+  static const bool stretch = false;
+
+  explicit StaticCenter(const T &child) : child_(child) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) {
+    child_.size(display, targetWidth, targetHeight, width, height);
+    if (*width < targetWidth) {
+      *width = targetWidth;
+    }
+    if (*height < targetHeight) {
+      *height = targetHeight;
+    }
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) {
+    int16_t x0_offset = 0, y0_offset = 0;
+    child_.size(display, targetWidth, targetHeight, width, height);
+    if (*width < targetWidth) {
+      x0_offset = (targetWidth - *width) / 2;
+    }
+    if (*height < targetHeight) {
+      y0_offset = (targetHeight - *height) / 2;
+    }
+    child_.draw(display, x0 + x0_offset, y0 + y0_offset, *width, *height,
+                width, height);
+    *width += x0_offset;
+    *height += y0_offset;
+    if (*width < targetWidth) {
+      *width = targetWidth;
+    }
+    if (*height < targetHeight) {
+      *height = targetHeight;
+    }
+  }
+
+private:
+  T child_;
+};
+
+// StaticCells is the list of cells of a StaticRows or StaticColumns, as a
+// head cell and the StaticCells of the rest. Each pass over the cells that
+// LayoutRows and LayoutColumns make in a loop is a recursive call here, which
+// the compiler unrolls.
+template <class... Cells> class StaticCells;
+
+template <> class StaticCells<> {
+public:
+  void sizeRows(Display *display, uint16_t targetWidth, uint16_t *width,
+                uint16_t *height, bool *canStretch) {}
+  void measureRows(Display *display, uint16_t *targetWidth,
+                   uint16_t *fixedHeight, uint16_t *splits) {}
+  void drawRows(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+                uint16_t remainingHeight, uint16_t splits, uint16_t *width,
+                uint16_t *height) {}
+
+  void sizeColumns(Display *display, uint16_t targetHeight, uint16_t *width,
+                   uint16_t *height, bool *canStretch) {}
+  void measureColumns(Display *display, uint16_t *targetHeight,
+                      uint16_t *fixedWidth, uint16_t *splits) {}
+  void drawColumns(Display *display, int16_t x0, int16_t y0,
+                   uint16_t targetHeight, uint16_t remainingWidth,
+                   uint16_t splits, uint16_t *width, uint16_t *height) {}
+};
+
+template <class Head, class... Rest> class StaticCells<Head, Rest...> {
+public:
+  StaticCells(const Head &head, const Rest &...rest)
+      : head_(head), rest_(rest...) {}
+
+  void sizeRows(Display *display, uint16_t targetWidth, uint16_t *width,
+                uint16_t *height, bool *canStretch) {
+    if (Head::stretch) {
+      *canStretch = true;
+    }
+    uint16_t rowWidth, rowHeight;
+    head_.size(display, targetWidth, 0, &rowWidth, &rowHeight);
+    if (rowWidth > *width) {
+      *width = rowWidth;
+    }
+    *height += rowHeight;
+    rest_.sizeRows(display, targetWidth, width, height, canStretch);
+  }
+
+  void measureRows(Display *display, uint16_t *targetWidth,
+                   uint16_t *fixedHeight, uint16_t *splits) {
+    uint16_t subwidth, subheight;
+    head_.size(display, *targetWidth, 0, &subwidth, &subheight);
+    if (subwidth > *targetWidth) {
+      *targetWidth = subwidth;
+    }
+    if (Head::stretch) {
+      (*splits)++;
+    } else {
+      *fixedHeight += subheight;
+    }
+    rest_.measureRows(display, targetWidth, fixedHeight, splits);
+  }
+
+  void drawRows(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+                uint16_t remainingHeight, uint16_t splits, uint16_t *width,
+                uint16_t *height) {
+    uint16_t subTargetHeight = 0;
+    if (Head::stretch) {
+      subTargetHeight = remainingHeight / splits;
+      remainingHeight -= subTargetHeight;
+      splits--;
+    }
+    uint16_t subwidth, subheight;
+    head_.draw(display, x0, y0 + *height, targetWidth, subTargetHeight,
+               &subwidth, &subheight);
+    *height += subheight;
+    if (subwidth > *width) {
+      *width = subwidth;
+    }
+    rest_.drawRows(display, x0, y0, targetWidth, remainingHeight, splits,
+                   width, height);
+  }
+
+  void sizeColumns(Display *display, uint16_t targetHeight, uint16_t *width,
+                   uint16_t *height, bool *canStretch) {
+    if (Head::stretch) {
+      *canStretch = true;
+    }
+    uint16_t columnWidth, columnHeight;
+    head_.size(display, 0, targetHeight, &columnWidth, &columnHeight);
+    if (columnHeight > *height) {
+      *height = columnHeight;
+    }
+    *width += columnWidth;
+    rest_.sizeColumns(display, targetHeight, width, height, canStretch);
+  }
+
+  void measureColumns(Display *display, uint16_t *targetHeight,
+                      uint16_t *fixedWidth, uint16_t *splits) {
+    uint16_t subwidth, subheight;
+    head_.size(display, 0, *targetHeight, &subwidth, &subheight);
+    if (subheight > *targetHeight) {
+      *targetHeight = subheight;
+    }
+    if (Head::stretch) {
+      (*splits)++;
+    } else {
+      *fixedWidth += subwidth;
+    }
+    rest_.measureColumns(display, targetHeight, fixedWidth, splits);
+  }
+
+  void drawColumns(Display *display, int16_t x0, int16_t y0,
+                   uint16_t targetHeight, uint16_t remainingWidth,
+                   uint16_t splits, uint16_t *width, uint16_t *height) {
+    uint16_t subTargetWidth = 0;
+    if (Head::stretch) {
+      subTargetWidth = remainingWidth / splits;
+      remainingWidth -= subTargetWidth;
+      splits--;
+    }
+    uint16_t subwidth, subheight;
+    head_.draw(display, x0 + *width, y0, subTargetWidth, targetHeight,
+               &subwidth, &subheight);
+    *width += subwidth;
+    if (subheight > *height) {
+      *height = subheight;
+    }
+    rest_.drawColumns(display, x0, y0, targetHeight, remainingWidth, splits,
+                      width, height);
+  }
+
+private:
+  Head head_;
+  StaticCells<Rest...> rest_;
+};
+
+// StaticRows stacks its cells vertically, like LayoutRows.
+template <class... Cells> class StaticRows {
+public:
+  static const bool stretch = false;
+
+  explicit StaticRows(const Cells &...cells) : cells_(cells...) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) {
+    *width          = targetWidth;
+    *height         = 0;
+    bool canStretch = false;
+    cells_.sizeRows(display, targetWidth, width, height, &canStretch);
+    if (*height < targetHeight && canStretch) {
+      *height = targetHeight;
+    }
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) {
+    uint16_t fixedHeight = 0;
+    uint16_t splits      = 0;
+    cells_.measureRows(display, &targetWidth, &fixedHeight, &splits);
+
+    uint16_t remainingHeight = 0;
+    if (targetHeight > fixedHeight) {
+      remainingHeight = targetHeight - fixedHeight;
+    }
+
+    *width  = 0;
+    *height = 0;
+    cells_.drawRows(display, x0, y0, targetWidth, remainingHeight, splits,
+                    width, height);
+  }
+
+private:
+  StaticCells<Cells...> cells_;
+};
+
+// StaticColumns stacks its cells horizontally, like LayoutColumns.
+template <class... Cells> class StaticColumns {
+public:
+  static const bool stretch = false;
+
+  explicit StaticColumns(const Cells &...cells) : cells_(cells...) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) {
+    *height         = targetHeight;
+    *width          = 0;
+    bool canStretch = false;
+    cells_.sizeColumns(display, targetHeight, width, height, &canStretch);
+    if (*width < targetWidth && canStretch) {
+      *width = targetWidth;
+    }
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) {
+    uint16_t fixedWidth = 0;
+    uint16_t splits     = 0;
+    cells_.measureColumns(display, &targetHeight, &fixedWidth, &splits);
+
+    uint16_t remainingWidth = 0;
+    if (targetWidth > fixedWidth) {
+      remainingWidth = targetWidth - fixedWidth;
+    }
+
+    *width  = 0;
+    *height = 0;
+    cells_.drawColumns(display, x0, y0, targetHeight, remainingWidth, splits,
+                       width, height);
+  }
+
+private:
+  StaticCells<Cells...> cells_;
+};
+
+// LayoutStatic puts a static tree inside a regular layout tree. It is one
+// LayoutElement however big the tree is, and like any element of unknown
+// contents it is volatile.
+template <class T> class LayoutStatic : public LayoutElement {
+public:
+  explicit LayoutStatic(const T &tree) : tree_(tree) {}
+  LayoutStatic(const LayoutStatic &copy) : tree_(copy.tree_) {}
+
+  void size(Display *display, uint16_t targetWidth, uint16_t targetHeight,
+            uint16_t *width, uint16_t *height) override {
+    tree_.size(display, targetWidth, targetHeight, width, height);
+  }
+
+  void draw(Display *display, int16_t x0, int16_t y0, uint16_t targetWidth,
+            uint16_t targetHeight, uint16_t *width, uint16_t *height) override {
+    tree_.draw(display, x0, y0, targetWidth, targetHeight, width, height);
+  }
+
+  LayoutElement::ptr clone() const override {
+    return LayoutElement::ptr(new LayoutStatic(*this));
+  }
+
+private:
+  T tree_;
+};
+
+inline StaticText staticText(const char *text, const GFXfont *font,
+                             uint16_t color) {
+  return StaticText(text, font, color);
+}
+
+inline StaticSpacer staticSpacer(uint16_t spacerSize) {
+  return StaticSpacer(spacerSize);
+}
+
+inline StaticFill staticFill() { return StaticFill(); }
+
+inline StaticElement staticElement(LayoutElement &elem) {
+  return StaticElement(elem);
+}
+
+template <class T> StaticStretch<T> staticStretch(const T &child) {
+  return StaticStretch<T>(child);
+}
+
+template <class T>
+StaticPad<T> staticPad(const T &child, int16_t padTop, int16_t padRight,
+                       int16_t padBottom, int16_t padLeft) {
+  return StaticPad<T>(child, padTop, padRight, padBottom, padLeft);
+}
+
+template <class T> StaticHCenter<T> staticHCenter(const T &child) {
+  return StaticHCenter<T>(child);
+}
+
+template <class T> StaticVCenter<T> staticVCenter(const T &child) {
+  return StaticVCenter<T>(child);
+}
+
+template <class T> StaticCenter<T> staticCenter(const T &child) {
+  return StaticCenter<T>(child);
+}
+
+template <class... Cells> StaticRows<Cells...> staticRows(const Cells &...cells) {
+  return StaticRows<Cells...>(cells...);
+}
+
+template <class... Cells>
+StaticColumns<Cells...> staticColumns(const Cells &...cells) {
+  return StaticColumns<Cells...>(cells...);
+}
+
+template <class T> LayoutStatic<T> layoutStatic(const T &tree) {
+  return LayoutStatic<T>(tree);
+}
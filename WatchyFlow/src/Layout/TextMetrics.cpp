@@ -0,0 +1,112 @@
+#include "TextMetrics.h"
+
+namespace {
+
+const uint8_t CACHE_SIZE = 16;
+
+typedef struct CachedBounds {
+  bool valid;
+  const GFXfont *font;
+  int16_t screenWidth;
+  uint16_t length;
+  uint32_t hash;
+  int16_t x1, y1;
+  uint16_t w, h;
+} CachedBounds;
+
+CachedBounds cache[CACHE_SIZE];
+
+} // namespace
+
+void forgetTextBounds() {
+  for (uint8_t i = 0; i < CACHE_SIZE; i++) {
+    cache[i].valid = false;
+  }
+}
+
+void textBounds(Display *display, const GFXfont *font, const char *text,
+                int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) {
+  display->setFont(font);
+
+  // FNV-1a
+  uint32_t hash   = 2166136261u;
+  uint16_t length = 0;
+  for (const char *p = text; *p; p++, length++) {
+    hash = (hash ^ (uint8_t)*p) * 16777619u;
+  }
+
+  CachedBounds *entry = &cache[hash % CACHE_SIZE];
+  if (entry->valid && entry->font == font &&
+      entry->screenWidth == display->width() && entry->length == length &&
+      entry->hash == hash) {
+    *x1 = entry->x1;
+    *y1 = entry->y1;
+    *w  = entry->w;
+    *h  = entry->h;
+    return;
+  }
+
+  display->getTextBounds(text, 0, 0, x1, y1, w, h);
+  entry->valid       = true;
+  entry->font        = font;
+  entry->screenWidth = display->width();
+  entry->length      = length;
+  entry->hash        = hash;
+  entry->x1          = *x1;
+  entry->y1          = *y1;
+  entry->w           = *w;
+  entry->h           = *h;
+}
+
+void textBounds(Display *display, const GFXfont *font, const String &text,
+                int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) {
+  textBounds(display, font, text.c_str(), x1, y1, w, h);
+}
+
+uint8_t glyphAdvance(const GFXfont *font, char c) {
+  if (!font) {
+    // the built-in font is 5x7 in a 6x8 cell.
+    return 6;
+  }
+  uint8_t ch = c;
+  if (ch < pgm_read_word(&font->first) || ch > pgm_read_word(&font->last)) {
+    return 0;
+  }
+  GFXglyph *glyph = (GFXglyph *)pgm_read_pointer(&font->glyph) +
+                    (ch - pgm_read_word(&font->first));
+  return pgm_read_byte(&glyph->xAdvance);
+}
+
+uint16_t TextRun::add(char c) {
+  // this follows Adafruit_GFX::charBounds() for a text size of 1.
+  if (c == '\n') {
+    x_ = 0;
+    return width();
+  }
+  if (c == '\r') {
+    return width();
+  }
+
+  int16_t left, right;
+  if (!font_) {
+    left  = x_;
+    right = x_ + 5;
+  } else {
+    uint8_t ch = c;
+    if (ch < pgm_read_word(&font_->first) || ch > pgm_read_word(&font_->last)) {
+      return width();
+    }
+    GFXglyph *glyph = (GFXglyph *)pgm_read_pointer(&font_->glyph) +
+                      (ch - pgm_read_word(&font_->first));
+    left  = x_ + (int8_t)pgm_read_byte(&glyph->xOffset);
+    right = left + pgm_read_byte(&glyph->width) - 1;
+  }
+  if (left < minx_) {
+    minx_ = left;
+  }
+  if (right > maxx_) {
+    maxx_ = right;
+  }
+  x_ += glyphAdvance(font_, c);
+  return width();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../Watchy/Watchy.h"
+
+// textBounds sets the display's font to font and then reports what
+// display->getTextBounds(text, 0, 0, ...) would. Results are remembered until
+// the next LayoutElement::startFrame(), keyed by the font, the screen width
+// and a hash of the text, so measuring and then drawing the same text in one
+// frame only computes its bounds once. They can't be kept any longer than a
+// frame, because the display's text wrap setting, which also changes the
+// bounds, can't be read back.
+void textBounds(Display *display, const GFXfont *font, const char *text,
+                int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
+void textBounds(Display *display, const GFXfont *font, const String &text,
+                int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
+
+// forgetTextBounds forgets everything textBounds remembers. It's called by
+// LayoutElement::startFrame().
+void forgetTextBounds();
+
+// glyphAdvance is how far the cursor moves after printing c in font.
+uint8_t glyphAdvance(const GFXfont *font, char c);
+
+// TextRun measures text a character at a time, straight from the font's glyph
+// tables, so finding how much of a string fits in a width is a single pass
+// instead of a getTextBounds call per prefix. The width of a run is what
+// getTextBounds reports for the same text without wrapping.
+class TextRun {
+public:
+  explicit TextRun(const GFXfont *font)
+      : font_(font), x_(0), minx_(INT16_MAX), maxx_(-1) {}
+
+  // add extends the run by c and returns the run's new width.
+  uint16_t add(char c);
+  uint16_t width() const { return maxx_ >= minx_ ? maxx_ - minx_ + 1 : 0; }
+
+private:
+  const GFXfont *font_;
+  int16_t x_;
+  int16_t minx_;
+  int16_t maxx_;
+};
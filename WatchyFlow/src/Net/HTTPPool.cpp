@@ -0,0 +1,114 @@
+#include "HTTPPool.h"
+
+#ifdef ESP32
+#define POOL_LOCK()   portENTER_CRITICAL(&lock_)
+#define POOL_UNLOCK() portEXIT_CRITICAL(&lock_)
+#else
+#define POOL_LOCK()
+#define POOL_UNLOCK()
+#endif
+
+namespace {
+// serverOf returns url up to the end of its host and port, such as
+// "https://example.com:8443".
+String serverOf(const String &url) {
+  int start = url.indexOf(String("://"));
+  start     = start < 0 ? 0 : start + 3;
+  for (unsigned int i = start; i < url.length(); i++) {
+    if (url[i] == '/' || url[i] == '?' || url[i] == '#') {
+      return url.substring(0, i);
+    }
+  }
+  return url;
+}
+} // namespace
+
+HTTPPool::HTTPPool() {
+#ifdef ESP32
+  lock_ = portMUX_INITIALIZER_UNLOCKED;
+#endif
+  for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+    slots_[i].busy = false;
+    slots_[i].client.setReuse(true);
+  }
+}
+
+HTTPClient *HTTPPool::acquire(const String &url) {
+  String server = serverOf(url);
+
+  Slot *slot = NULL;
+  POOL_LOCK();
+  for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+    if (slots_[i].busy) {
+      continue;
+    }
+    if (slots_[i].server == server) {
+      slot = &slots_[i];
+      break;
+    }
+    // an unused client is the next best thing, then any idle one.
+    if (!slot || (slot->server.length() > 0 &&
+                  slots_[i].server.length() == 0)) {
+      slot = &slots_[i];
+    }
+  }
+  if (slot) {
+    slot->busy = true;
+  }
+  POOL_UNLOCK();
+
+  if (!slot) {
+    return NULL;
+  }
+  if (slot->server != server) {
+    // HTTPClient would otherwise send this request down the connection it
+    // already has, to the wrong server.
+    close(slot);
+    slot->server = server;
+  }
+  slot->client.begin(url);
+  return &slot->client;
+}
+
+void HTTPPool::release(HTTPClient *http) {
+  // with reuse on, end() leaves the connection open.
+  http->end();
+  POOL_LOCK();
+  for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+    if (&slots_[i].client == http) {
+      slots_[i].busy = false;
+    }
+  }
+  POOL_UNLOCK();
+}
+
+void HTTPPool::closeAll() {
+  for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+    close(&slots_[i]);
+    slots_[i].server = "";
+  }
+}
+
+void HTTPPool::close(Slot *slot) {
+  slot->client.setReuse(false);
+  slot->client.end();
+  slot->client.setReuse(true);
+}
+
+PooledHTTP::PooledHTTP(HTTPPool &pool, const String &url)
+    : pool_(pool), http_(pool.acquire(url)), pooled_(true) {
+  if (!http_) {
+    http_   = new HTTPClient();
+    pooled_ = false;
+    http_->begin(url);
+  }
+}
+
+PooledHTTP::~PooledHTTP() {
+  if (pooled_) {
+    pool_.release(http_);
+  } else {
+    http_->end();
+    delete http_;
+  }
+}
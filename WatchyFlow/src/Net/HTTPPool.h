@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+
+const uint8_t HTTP_POOL_SIZE = 4;
+
+// HTTPPool lends out HTTPClients that keep their connections open after a
+// request, so later requests to the same scheme, host and port in the same
+// wakeup skip the TCP and TLS handshakes. It's safe to use from the tasks
+// runParallel starts. Watchy owns one, see Watchy::http().
+class HTTPPool {
+public:
+  HTTPPool();
+
+  HTTPPool(const HTTPPool &copy)            = delete;
+  HTTPPool &operator=(const HTTPPool &copy) = delete;
+
+  // acquire returns an idle client, preferring one already connected to
+  // url's server, and begins a request for url on it. It returns NULL if
+  // every client is in use.
+  HTTPClient *acquire(const String &url);
+  // release ends the client's request, leaving its connection open for the
+  // next acquire.
+  void release(HTTPClient *http);
+  // closeAll closes every connection. Watchy calls it before turning WiFi
+  // off.
+  void closeAll();
+
+private:
+  typedef struct Slot {
+    HTTPClient client;
+    // the scheme, host and port the client was last connected to.
+    String server;
+    bool busy;
+  } Slot;
+
+  void close(Slot *slot);
+
+  Slot slots_[HTTP_POOL_SIZE];
+#ifdef ESP32
+  portMUX_TYPE lock_;
+#endif
+};
+
+// PooledHTTP borrows a client from an HTTPPool for as long as it's in scope,
+// and begins a request for url on it. If the pool has no clients left, it
+// uses one of its own that isn't kept afterwards.
+class PooledHTTP {
+public:
+  PooledHTTP(HTTPPool &pool, const String &url);
+  ~PooledHTTP();
+
+  PooledHTTP(const PooledHTTP &copy)            = delete;
+  PooledHTTP &operator=(const PooledHTTP &copy) = delete;
+
+  HTTPClient *operator->() { return http_; }
+  HTTPClient &operator*() { return *http_; }
+
+private:
+  HTTPPool &pool_;
+  HTTPClient *http_;
+  bool pooled_;
+};
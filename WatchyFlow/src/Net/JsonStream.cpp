@@ -0,0 +1,281 @@
+#include "JsonStream.h"
+
+namespace {
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+bool isLiteral(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+         (c >= 'A' && c <= 'Z') || c == '-' || c == '+' || c == '.';
+}
+
+int8_t hexDigit(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+} // namespace
+
+JsonStream::JsonStream(JsonHandler *handler)
+    : handler_(handler), state_(EXPECT_VALUE), objects_(0), depth_(0),
+      stringIsKey_(false), unicodeDigits_(0), unicode_(0), len_(0) {}
+
+bool JsonStream::feed(const char *buf, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    if (!feed(buf[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool JsonStream::feed(char c) {
+  switch (state_) {
+  case IN_STRING:
+    if (c == '"') {
+      return endString();
+    }
+    if (c == '\\') {
+      state_ = IN_ESCAPE;
+      return true;
+    }
+    append(c);
+    return true;
+
+  case IN_ESCAPE:
+    state_ = IN_STRING;
+    switch (c) {
+    case 'b':
+      append('\b');
+      return true;
+    case 'f':
+      append('\f');
+      return true;
+    case 'n':
+      append('\n');
+      return true;
+    case 'r':
+      append('\r');
+      return true;
+    case 't':
+      append('\t');
+      return true;
+    case 'u':
+      state_         = IN_UNICODE;
+      unicode_       = 0;
+      unicodeDigits_ = 0;
+      return true;
+    case '"':
+    case '\\':
+    case '/':
+      append(c);
+      return true;
+    }
+    return fail();
+
+  case IN_UNICODE: {
+    int8_t digit = hexDigit(c);
+    if (digit < 0) {
+      return fail();
+    }
+    unicode_ = (unicode_ << 4) | digit;
+    if (++unicodeDigits_ == 4) {
+      // the display fonts only have ASCII.
+      append(unicode_ < 0x80 ? (char)unicode_ : '?');
+      state_ = IN_STRING;
+    }
+    return true;
+  }
+
+  case IN_LITERAL:
+    if (isLiteral(c)) {
+      append(c);
+      return true;
+    }
+    if (!endLiteral()) {
+      return false;
+    }
+    // whatever ended the literal still needs parsing.
+    return feed(c);
+
+  case DONE:
+    return true;
+
+  case FAILED:
+    return false;
+
+  default:
+    break;
+  }
+
+  if (isSpace(c)) {
+    return true;
+  }
+
+  switch (state_) {
+  case EXPECT_VALUE_OR_END:
+    if (c == ']') {
+      return endContainer(false);
+    }
+    return startValue(c);
+
+  case EXPECT_VALUE:
+    return startValue(c);
+
+  case EXPECT_KEY_OR_END:
+    if (c == '}') {
+      return endContainer(true);
+    }
+    // fall through
+  case EXPECT_KEY:
+    if (c != '"') {
+      return fail();
+    }
+    state_       = IN_STRING;
+    stringIsKey_ = true;
+    len_         = 0;
+    return true;
+
+  case EXPECT_COLON:
+    if (c != ':') {
+      return fail();
+    }
+    state_ = EXPECT_VALUE;
+    return true;
+
+  case EXPECT_COMMA_OR_END:
+    if (c == ',') {
+      state_ = inObject() ? EXPECT_KEY : EXPECT_VALUE;
+      return true;
+    }
+    if (c == (inObject() ? '}' : ']')) {
+      return endContainer(inObject());
+    }
+    return fail();
+
+  default:
+    return fail();
+  }
+}
+
+bool JsonStream::read(Stream *stream) {
+  char buf[64];
+  while (!done()) {
+    // asking for more than has arrived would wait out the stream's timeout
+    // at the end of the document.
+    int available = stream->available();
+    size_t n      = 1;
+    if (available > 0) {
+      n = (size_t)available < sizeof(buf) ? available : sizeof(buf);
+    }
+    if (stream->readBytes(buf, n) != n) {
+      return false;
+    }
+    if (!feed(buf, n)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool JsonStream::startValue(char c) {
+  if (c == '{') {
+    return startContainer(true);
+  }
+  if (c == '[') {
+    return startContainer(false);
+  }
+  len_ = 0;
+  if (c == '"') {
+    state_       = IN_STRING;
+    stringIsKey_ = false;
+    return true;
+  }
+  if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' ||
+      c == 'n') {
+    state_ = IN_LITERAL;
+    append(c);
+    return true;
+  }
+  return fail();
+}
+
+bool JsonStream::startContainer(bool object) {
+  if (depth_ >= JSON_MAX_DEPTH) {
+    return fail();
+  }
+  if (object) {
+    objects_ |= (uint32_t)1 << depth_;
+    handler_->startObject();
+    state_ = EXPECT_KEY_OR_END;
+  } else {
+    objects_ &= ~((uint32_t)1 << depth_);
+    handler_->startArray();
+    state_ = EXPECT_VALUE_OR_END;
+  }
+  depth_++;
+  return true;
+}
+
+bool JsonStream::endContainer(bool object) {
+  depth_--;
+  if (object) {
+    handler_->endObject();
+  } else {
+    handler_->endArray();
+  }
+  endValue();
+  return true;
+}
+
+bool JsonStream::endString() {
+  token_[len_] = 0;
+  if (stringIsKey_) {
+    handler_->key(token_);
+    state_ = EXPECT_COLON;
+    return true;
+  }
+  handler_->value(JSON_STRING, token_);
+  endValue();
+  return true;
+}
+
+bool JsonStream::endLiteral() {
+  token_[len_] = 0;
+  JsonType type;
+  if (strcmp(token_, "true") == 0) {
+    type = JSON_TRUE;
+  } else if (strcmp(token_, "false") == 0) {
+    type = JSON_FALSE;
+  } else if (strcmp(token_, "null") == 0) {
+    type = JSON_NULL;
+  } else if (token_[0] == '-' || (token_[0] >= '0' && token_[0] <= '9')) {
+    type = JSON_NUMBER;
+  } else {
+    return fail();
+  }
+  handler_->value(type, token_);
+  endValue();
+  return true;
+}
+
+void JsonStream::endValue() {
+  state_ = depth_ == 0 ? DONE : EXPECT_COMMA_OR_END;
+}
+
+void JsonStream::append(char c) {
+  if (len_ < JSON_TOKEN_LEN - 1) {
+    token_[len_++] = c;
+  }
+}
+
+bool JsonStream::fail() {
+  state_ = FAILED;
+  return false;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <Arduino.h>
+
+typedef enum JsonType {
+  JSON_STRING,
+  JSON_NUMBER,
+  JSON_TRUE,
+  JSON_FALSE,
+  JSON_NULL,
+} JsonType;
+
+// JsonHandler is told about each part of a JSON document as JsonStream reads
+// it. Nothing is kept once a callback returns, so a handler copies out what
+// it needs.
+class JsonHandler {
+public:
+  virtual ~JsonHandler() = default;
+
+  virtual void startObject() {}
+  virtual void endObject() {}
+  virtual void startArray() {}
+  virtual void endArray() {}
+  // key is called with each key in an object, before the key's value.
+  virtual void key(const char *key) {}
+  // value is called with every string, number, boolean and null. numbers are
+  // given as they were written.
+  virtual void value(JsonType type, const char *value) {}
+};
+
+// strings and numbers longer than this are cut short.
+const uint8_t JSON_TOKEN_LEN = 64;
+const uint8_t JSON_MAX_DEPTH = 32;
+
+// JsonStream parses JSON a byte at a time as it arrives, instead of needing
+// the whole document in memory first like Arduino_JSON does. It uses the same
+// small, fixed amount of memory however long the document is.
+class JsonStream {
+public:
+  explicit JsonStream(JsonHandler *handler);
+
+  // feed parses the next bytes of the document. it returns false once the
+  // document is known to be malformed.
+  bool feed(char c);
+  bool feed(const char *buf, size_t len);
+
+  // read feeds the parser from stream until the document is complete.
+  bool read(Stream *stream);
+
+  // done is true once the whole document has been parsed.
+  bool done() { return state_ == DONE; }
+
+private:
+  typedef enum State {
+    EXPECT_VALUE,
+    EXPECT_VALUE_OR_END,
+    EXPECT_KEY,
+    EXPECT_KEY_OR_END,
+    EXPECT_COLON,
+    EXPECT_COMMA_OR_END,
+    IN_STRING,
+    IN_ESCAPE,
+    IN_UNICODE,
+    IN_LITERAL,
+    DONE,
+    FAILED,
+  } State;
+
+  bool startValue(char c);
+  bool startContainer(bool object);
+  bool endContainer(bool object);
+  bool endString();
+  bool endLiteral();
+  void endValue();
+  bool inObject() { return (objects_ >> (depth_ - 1)) & 1; }
+  void append(char c);
+  bool fail();
+
+  JsonHandler *handler_;
+  State state_;
+  // bit n of objects_ is set if the container at depth n + 1 is an object.
+  uint32_t objects_;
+  uint8_t depth_;
+  bool stringIsKey_;
+  uint8_t unicodeDigits_;
+  uint16_t unicode_;
+  uint8_t len_;
+  char token_[JSON_TOKEN_LEN];
+};
@@ -0,0 +1,73 @@
+#include "Parallel.h"
+
+namespace {
+RTC_DATA_ATTR uint16_t jobMillis[PARALLEL_MAX_JOBS];
+RTC_DATA_ATTR uint8_t jobCount;
+
+void runJob(ParallelJob *job) {
+  uint32_t start = millis();
+  job->run(job->arg);
+  job->millis = millis() - start;
+}
+
+#ifdef ESP32
+typedef struct JobTask {
+  ParallelJob *job;
+  TaskHandle_t waiter;
+} JobTask;
+
+void jobTask(void *arg) {
+  JobTask *task = static_cast<JobTask *>(arg);
+  runJob(task->job);
+  // a notification lives in the waiting task itself, so unlike a semaphore
+  // there's nothing the waiter has to be careful not to free too early.
+  xTaskNotifyGive(task->waiter);
+  vTaskDelete(NULL);
+}
+#endif
+} // namespace
+
+void runParallel(ParallelJob *jobs, uint8_t count) {
+  if (count > PARALLEL_MAX_JOBS) {
+    count = PARALLEL_MAX_JOBS;
+  }
+
+#ifdef ESP32
+  JobTask tasks[PARALLEL_MAX_JOBS];
+  uint8_t started = 0;
+  // forget any notification left over from before.
+  ulTaskNotifyTake(pdTRUE, 0);
+  for (uint8_t i = 1; i < count; i++) {
+    tasks[i].job    = &jobs[i];
+    tasks[i].waiter = xTaskGetCurrentTaskHandle();
+    if (xTaskCreatePinnedToCore(jobTask, "job", PARALLEL_STACK_SIZE, &tasks[i],
+                                uxTaskPriorityGet(NULL), NULL,
+                                xPortGetCoreID() ^ 1) == pdPASS) {
+      started++;
+    } else {
+      runJob(&jobs[i]);
+    }
+  }
+  if (count > 0) {
+    runJob(&jobs[0]);
+  }
+  while (started > 0) {
+    started -= ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+#else
+  for (uint8_t i = 0; i < count; i++) {
+    runJob(&jobs[i]);
+  }
+#endif
+
+  jobCount = count;
+  for (uint8_t i = 0; i < count; i++) {
+    jobMillis[i] = jobs[i].millis > UINT16_MAX ? UINT16_MAX : jobs[i].millis;
+  }
+}
+
+uint16_t lastParallelMillis(uint8_t job) {
+  return job < jobCount ? jobMillis[job] : 0;
+}
+
+uint8_t lastParallelJobs() { return jobCount; }
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+
+const uint8_t PARALLEL_MAX_JOBS    = 4;
+const uint32_t PARALLEL_STACK_SIZE = 8192;
+
+// ParallelJob is one of the things runParallel does at once.
+typedef struct ParallelJob {
+  void (*run)(void *arg);
+  void *arg;
+  // millis is set to how long run took.
+  uint32_t millis;
+} ParallelJob;
+
+// runParallel runs every job at the same time and returns once they're all
+// done. The first job runs on the calling task, and each of the others on a
+// task of its own on the other core, so that waiting on several network round
+// trips takes as long as the slowest one instead of all of them added up.
+// Jobs must not touch the same state, and can't rely on any more than
+// PARALLEL_STACK_SIZE bytes of stack. Without FreeRTOS, such as in the bench,
+// the jobs run one after another.
+void runParallel(ParallelJob *jobs, uint8_t count);
+
+// lastParallelMillis returns how long job took in the last runParallel(),
+// kept across deep sleep for diagnostics, and lastParallelJobs how many jobs
+// there were.
+uint16_t lastParallelMillis(uint8_t job);
+uint8_t lastParallelJobs();
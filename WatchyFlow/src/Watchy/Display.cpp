@@ -19,10 +19,32 @@
 // performance for Watchy Project: Link: https://github.com/sqfmi/Watchy
 
 #include "Display.h"
+#include "RowCopy.h"
 
 namespace {
 RTC_DATA_ATTR bool displayFullInit = true;
+
+// the last frame sent to the controller is remembered as a hash of each band
+// of BAND_ROWS rows, so the next frame only needs to send and refresh the
+// bands that changed, or nothing at all. The controller keeps its RAM in deep
+// sleep, so these are kept in RTC memory too.
+const uint16_t BAND_ROWS  = 8;
+const uint16_t BAND_BYTES = BAND_ROWS * WatchyDisplay::WIDTH / 8;
+const uint16_t BANDS      = WatchyDisplay::HEIGHT / BAND_ROWS;
+RTC_DATA_ATTR uint32_t bandHashes[BANDS];
+RTC_DATA_ATTR bool bandHashesValid;
+RTC_DATA_ATTR uint32_t skippedRefreshes;
+
+uint32_t hashBand(const uint8_t bitmap[], uint16_t band) {
+  // FNV-1a
+  const uint8_t *data = bitmap + band * BAND_BYTES;
+  uint32_t hash       = 2166136261u;
+  for (uint16_t i = 0; i < BAND_BYTES; i++) {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  return hash;
 }
+} // namespace
 
 void WatchyDisplay::busyCallback(const void *) {
   gpio_wakeup_enable((gpio_num_t)DISPLAY_BUSY, GPIO_INTR_LOW_LEVEL);
@@ -55,6 +77,50 @@ void WatchyDisplay::asyncPowerOn() {
   }
 }
 
+void WatchyDisplay::awaitRefresh() {
+  if (!waitingRefresh)
+    return;
+  waitingRefresh = false;
+  // poll instead of going through busyCallback, since light sleep would
+  // stall whatever the refresh is overlapping with, such as WiFi. like
+  // _waitWhileBusy, _busy_timeout is in microseconds.
+  unsigned long start = micros();
+  while (digitalRead(_busy) == _busy_level && micros() - start < _busy_timeout)
+    delay(1);
+  if (againPending_) {
+    againPending_ = false;
+    _writeImagePart(0x24, again_.bitmap, again_.x_part, again_.y_part,
+                    again_.w_bitmap, again_.h_bitmap, again_.x, again_.y,
+                    again_.w, again_.h, again_.invert, again_.mirror_y,
+                    again_.pgm);
+  }
+}
+
+void WatchyDisplay::_startTransfer() {
+  awaitRefresh();
+  GxEPD2_EPD::_startTransfer();
+}
+
+void WatchyDisplay::_deferAgain(const uint8_t bitmap[], int16_t x_part,
+                                int16_t y_part, int16_t w_bitmap,
+                                int16_t h_bitmap, int16_t x, int16_t y,
+                                int16_t w, int16_t h, bool invert,
+                                bool mirror_y, bool pgm) {
+  again_.bitmap   = bitmap;
+  again_.x_part   = x_part;
+  again_.y_part   = y_part;
+  again_.w_bitmap = w_bitmap;
+  again_.h_bitmap = h_bitmap;
+  again_.x        = x;
+  again_.y        = y;
+  again_.w        = w;
+  again_.h        = h;
+  again_.invert   = invert;
+  again_.mirror_y = mirror_y;
+  again_.pgm      = pgm;
+  againPending_   = true;
+}
+
 void WatchyDisplay::setDarkBorder(bool dark) {
   if (_hibernating)
     return;
@@ -72,6 +138,7 @@ void WatchyDisplay::clearScreen(uint8_t value) {
 }
 
 void WatchyDisplay::writeScreenBuffer(uint8_t value) {
+  bandHashesValid = false;
   if (!_using_partial_mode)
     _Init_Part();
   if (_initial_write)
@@ -81,6 +148,7 @@ void WatchyDisplay::writeScreenBuffer(uint8_t value) {
 }
 
 void WatchyDisplay::writeScreenBufferAgain(uint8_t value) {
+  bandHashesValid = false;
   if (!_using_partial_mode)
     _Init_Part();
   _writeScreenBuffer(0x24, value); // set current
@@ -89,8 +157,10 @@ void WatchyDisplay::writeScreenBufferAgain(uint8_t value) {
 void WatchyDisplay::_writeScreenBuffer(uint8_t command, uint8_t value) {
   _startTransfer();
   _transferCommand(command);
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++) {
-    _transfer(value);
+  uint8_t row[WIDTH / 8];
+  memset(row, value, sizeof(row));
+  for (uint16_t i = 0; i < HEIGHT; i++) {
+    _pSPIx->writeBytes(row, sizeof(row));
   }
   _endTransfer();
 }
@@ -98,13 +168,80 @@ void WatchyDisplay::_writeScreenBuffer(uint8_t command, uint8_t value) {
 void WatchyDisplay::writeImage(const uint8_t bitmap[], int16_t x, int16_t y,
                                int16_t w, int16_t h, bool invert, bool mirror_y,
                                bool pgm) {
+  frameDiffed_ = false;
+  if (_isFrame(bitmap, x, y, w, h, invert, mirror_y, pgm)) {
+    // this is GxEPD2_BW::display() sending its whole buffer.
+    _diffFrame(bitmap, 0, HEIGHT);
+    if (frameH_ > 0) {
+      _writeImage(0x24, bitmap + frameY_ * WIDTH / 8, 0, frameY_, WIDTH,
+                  frameH_);
+    }
+    return;
+  }
+  bandHashesValid = false;
   _writeImage(0x24, bitmap, x, y, w, h, invert, mirror_y, pgm);
 }
 
+bool WatchyDisplay::_isFrame(const uint8_t bitmap[], int16_t x, int16_t y,
+                             int16_t w, int16_t h, bool invert, bool mirror_y,
+                             bool pgm) {
+  return x == 0 && y == 0 && w == WIDTH && h == HEIGHT && !invert &&
+         !mirror_y && !pgm;
+}
+
+void WatchyDisplay::_diffFrame(const uint8_t bitmap[], int16_t y, int16_t h) {
+  if (_initial_write) {
+    writeScreenBuffer(); // clears the controller memory and the hashes
+  }
+  // with no trustworthy hashes, everything has changed. hashes of part of a
+  // frame can be updated, but only hashing a whole frame makes them all
+  // trustworthy again.
+  bool valid = bandHashesValid && !_initial_refresh;
+  if (y == 0 && h == HEIGHT) {
+    bandHashesValid = true;
+  }
+
+  int16_t first = -1, last = -1;
+  for (uint16_t band = y / BAND_ROWS; band < BANDS && band * BAND_ROWS < y + h;
+       band++) {
+    uint32_t hash = hashBand(bitmap, band);
+    if (!valid || hash != bandHashes[band]) {
+      if (first < 0) {
+        first = band;
+      }
+      last = band;
+    }
+    bandHashes[band] = hash;
+  }
+
+  frameDiffed_ = true;
+  frameY_      = y;
+  frameH_      = 0;
+  if (first >= 0) {
+    int16_t end = (last + 1) * BAND_ROWS;
+    if (end > y + h) {
+      end = y + h;
+    }
+    if (first * BAND_ROWS > y) {
+      frameY_ = first * BAND_ROWS;
+    }
+    frameH_ = end - frameY_;
+  }
+}
+
+uint32_t WatchyDisplay::skippedRefreshes() { return ::skippedRefreshes; }
+
 void WatchyDisplay::writeImageForFullRefresh(const uint8_t bitmap[], int16_t x,
                                              int16_t y, int16_t w, int16_t h,
                                              bool invert, bool mirror_y,
                                              bool pgm) {
+  // a full refresh sends everything, but the hashes still need to match what
+  // was sent for the next frame's diff.
+  bandHashesValid = false;
+  if (_isFrame(bitmap, x, y, w, h, invert, mirror_y, pgm)) {
+    _diffFrame(bitmap, 0, HEIGHT);
+  }
+  frameDiffed_ = false;
   _writeImage(0x26, bitmap, x, y, w, h, invert, mirror_y, pgm);
   _writeImage(0x24, bitmap, x, y, w, h, invert, mirror_y, pgm);
 }
@@ -112,6 +249,19 @@ void WatchyDisplay::writeImageForFullRefresh(const uint8_t bitmap[], int16_t x,
 void WatchyDisplay::writeImageAgain(const uint8_t bitmap[], int16_t x,
                                     int16_t y, int16_t w, int16_t h,
                                     bool invert, bool mirror_y, bool pgm) {
+  if (frameDiffed_ && _isFrame(bitmap, x, y, w, h, invert, mirror_y, pgm)) {
+    frameDiffed_ = false;
+    if (frameH_ <= 0)
+      return;
+    bitmap += frameY_ * WIDTH / 8;
+    y = frameY_;
+    h = frameH_;
+  }
+  if (waitingRefresh) {
+    // the panel is still busy, so this waits until the refresh is done.
+    _deferAgain(bitmap, 0, 0, w, h, x, y, w, h, invert, mirror_y, pgm);
+    return;
+  }
   _writeImage(0x24, bitmap, x, y, w, h, invert, mirror_y, pgm);
 }
 
@@ -141,37 +291,56 @@ void WatchyDisplay::_writeImage(uint8_t command, const uint8_t bitmap[],
   _setPartialRamArea(x1, y1, w1, h1);
   _startTransfer();
   _transferCommand(command);
-  for (int16_t i = 0; i < h1; i++) {
-    for (int16_t j = 0; j < w1 / 8; j++) {
-      uint8_t data;
-      // use wb, h of bitmap for index!
-      int16_t idx = mirror_y ? j + dx / 8 + ((h - 1 - (i + dy))) * wb
-                             : j + dx / 8 + (i + dy) * wb;
-      if (pgm) {
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-        data = pgm_read_byte(&bitmap[idx]);
-#else
-        data = bitmap[idx];
-#endif
-      } else {
-        data = bitmap[idx];
-      }
-      if (invert)
-        data = ~data;
-      _transfer(data);
-    }
-  }
+  // use wb, h of bitmap for index!
+  int16_t row = mirror_y ? h - 1 - dy : dy;
+  _transferRows(bitmap + dx / 8 + row * wb, mirror_y ? -wb : wb, w1 / 8, h1,
+                invert);
   _endTransfer();
 #if defined(ESP8266) || defined(ESP32)
   yield(); // avoid wdt
 #endif
 }
 
+// _transferRows sends rows of rowBytes each, starting at first and stride
+// bytes apart, within a transfer the caller has started. pgm bitmaps need no
+// special handling, since the ESP32 maps flash into the address space.
+void WatchyDisplay::_transferRows(const uint8_t *first, int16_t stride,
+                                  int16_t rowBytes, int16_t rows,
+                                  bool invert) {
+  if (!invert && stride == rowBytes) {
+    // the rows are contiguous in the bitmap, so they can go in one write.
+    _pSPIx->writeBytes(first, (uint32_t)rowBytes * rows);
+    return;
+  }
+  uint8_t row[WIDTH / 8];
+  for (int16_t i = 0; i < rows; i++) {
+    copyRow(row, first + i * stride, rowBytes, invert);
+    _pSPIx->writeBytes(row, rowBytes);
+  }
+}
+
 void WatchyDisplay::writeImagePart(const uint8_t bitmap[], int16_t x_part,
                                    int16_t y_part, int16_t w_bitmap,
                                    int16_t h_bitmap, int16_t x, int16_t y,
                                    int16_t w, int16_t h, bool invert,
                                    bool mirror_y, bool pgm) {
+  frameDiffed_ = false;
+  if (x_part == x && y_part == y && y >= 0 && h > 0 && y + h <= HEIGHT &&
+      _isFrame(bitmap, 0, 0, w_bitmap, h_bitmap, invert, mirror_y, pgm)) {
+    // this is GxEPD2_BW::displayWindow() sending a window of its buffer.
+    _diffFrame(bitmap, y, h);
+    if (frameH_ > 0) {
+      _writeImagePart(0x24, bitmap, x, frameY_, WIDTH, HEIGHT, x, frameY_, w,
+                      frameH_);
+      if (x > 0 || w < WIDTH || y % BAND_ROWS || (y + h) % BAND_ROWS) {
+        // the hashes cover whole bands, but only some of their columns or
+        // rows were sent.
+        bandHashesValid = false;
+      }
+    }
+    return;
+  }
+  bandHashesValid = false;
   _writeImagePart(0x24, bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h,
                   invert, mirror_y, pgm);
 }
@@ -181,6 +350,20 @@ void WatchyDisplay::writeImagePartAgain(const uint8_t bitmap[], int16_t x_part,
                                         int16_t h_bitmap, int16_t x, int16_t y,
                                         int16_t w, int16_t h, bool invert,
                                         bool mirror_y, bool pgm) {
+  if (frameDiffed_ && x_part == x && y_part == y &&
+      _isFrame(bitmap, 0, 0, w_bitmap, h_bitmap, invert, mirror_y, pgm)) {
+    frameDiffed_ = false;
+    if (frameH_ <= 0)
+      return;
+    y_part = y = frameY_;
+    h          = frameH_;
+  }
+  if (waitingRefresh) {
+    // the panel is still busy, so this waits until the refresh is done.
+    _deferAgain(bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, invert,
+                mirror_y, pgm);
+    return;
+  }
   _writeImagePart(0x24, bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h,
                   invert, mirror_y, pgm);
 }
@@ -222,28 +405,10 @@ void WatchyDisplay::_writeImagePart(uint8_t command, const uint8_t bitmap[],
   _setPartialRamArea(x1, y1, w1, h1);
   _startTransfer();
   _transferCommand(command);
-  for (int16_t i = 0; i < h1; i++) {
-    for (int16_t j = 0; j < w1 / 8; j++) {
-      uint8_t data;
-      // use wb_bitmap, h_bitmap of bitmap for index!
-      int16_t idx =
-          mirror_y ? x_part / 8 + j + dx / 8 +
-                         ((h_bitmap - 1 - (y_part + i + dy))) * wb_bitmap
-                   : x_part / 8 + j + dx / 8 + (y_part + i + dy) * wb_bitmap;
-      if (pgm) {
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-        data = pgm_read_byte(&bitmap[idx]);
-#else
-        data = bitmap[idx];
-#endif
-      } else {
-        data = bitmap[idx];
-      }
-      if (invert)
-        data = ~data;
-      _transfer(data);
-    }
-  }
+  // use wb_bitmap, h_bitmap of bitmap for index!
+  int16_t row = mirror_y ? h_bitmap - 1 - (y_part + dy) : y_part + dy;
+  _transferRows(bitmap + x_part / 8 + dx / 8 + row * wb_bitmap,
+                mirror_y ? -wb_bitmap : wb_bitmap, w1 / 8, h1, invert);
   _endTransfer();
 #if defined(ESP8266) || defined(ESP32)
   yield(); // avoid wdt
@@ -338,6 +503,15 @@ void WatchyDisplay::refresh(bool partial_update_mode) {
 void WatchyDisplay::refresh(int16_t x, int16_t y, int16_t w, int16_t h) {
   if (_initial_refresh)
     return refresh(false); // initial update needs be full update
+  if (frameDiffed_) {
+    // only refresh the rows of the frame that changed, if any.
+    if (frameH_ <= 0) {
+      ::skippedRefreshes++;
+      return;
+    }
+    y = frameY_;
+    h = frameH_;
+  }
   // intersection with screen
   int16_t w1 = x < 0 ? w + x : w;                                     // reduce
   int16_t h1 = y < 0 ? h + y : h;                                     // reduce
@@ -361,6 +535,7 @@ void WatchyDisplay::refresh(int16_t x, int16_t y, int16_t w, int16_t h) {
 void WatchyDisplay::powerOff() { _PowerOff(); }
 
 void WatchyDisplay::hibernate() {
+  awaitRefresh();
   //_PowerOff(); // Not needed before entering deep sleep
   if (_rst >= 0) {
     _writeCommand(0x10); // deep sleep mode
@@ -505,7 +680,10 @@ void WatchyDisplay::_Update_Full() {
   _transfer(0xf4);
   _transferCommand(0x20);
   _endTransfer();
-  _waitWhileBusy("_Update_Full", full_refresh_time);
+  if (asyncRefresh)
+    waitingRefresh = true;
+  else
+    _waitWhileBusy("_Update_Full", full_refresh_time);
   displayFullInit = false;
 }
 
@@ -516,7 +694,10 @@ void WatchyDisplay::_Update_Part() {
   _transfer(0xfc);
   _transferCommand(0x20);
   _endTransfer();
-  _waitWhileBusy("_Update_Part", partial_refresh_time);
+  if (asyncRefresh)
+    waitingRefresh = true;
+  else
+    _waitWhileBusy("_Update_Part", partial_refresh_time);
 }
 
 void WatchyDisplay::_transferCommand(uint8_t value) {
@@ -45,6 +45,12 @@ public:
   void asyncPowerOn();
   void _PowerOnAsync();
   bool waitingPowerOn = false;
+  // with asyncRefresh set, a refresh returns as soon as the panel has started
+  // it. The next write to the panel waits for it to finish, as does
+  // awaitRefresh(), so other work can happen in between.
+  bool asyncRefresh   = false;
+  bool waitingRefresh = false;
+  void awaitRefresh();
   static void busyCallback(const void *);
   // methods (virtual)
   //  Support for Bitmaps (Sprites) to Controller Buffer and to Screen
@@ -127,7 +133,33 @@ public:
   bool darkBorder = false; // adds a dark border outside the normal screen area
 
   static constexpr bool reduceBoosterTime = true; // Saves ~200ms
+
+  // how many partial refreshes were skipped since power on because the frame
+  // had not changed.
+  uint32_t skippedRefreshes();
+
 private:
+  // a write to the controller's memory waiting for an asyncRefresh to end.
+  struct PendingWrite {
+    const uint8_t *bitmap;
+    int16_t x_part, y_part, w_bitmap, h_bitmap, x, y, w, h;
+    bool invert, mirror_y, pgm;
+  };
+  bool againPending_ = false;
+  PendingWrite again_;
+  void _deferAgain(const uint8_t bitmap[], int16_t x_part, int16_t y_part,
+                   int16_t w_bitmap, int16_t h_bitmap, int16_t x, int16_t y,
+                   int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm);
+  void _startTransfer();
+
+  // the rows of the current frame that changed since the last frame, set by
+  // writeImage/writeImagePart and used by the refresh and write again after.
+  bool frameDiffed_ = false;
+  int16_t frameY_   = 0;
+  int16_t frameH_   = 0;
+  bool _isFrame(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w,
+                int16_t h, bool invert, bool mirror_y, bool pgm);
+  void _diffFrame(const uint8_t bitmap[], int16_t y, int16_t h);
   void _writeScreenBuffer(uint8_t command, uint8_t value);
   void _writeImage(uint8_t command, const uint8_t bitmap[], int16_t x,
                    int16_t y, int16_t w, int16_t h, bool invert = false,
@@ -137,6 +169,8 @@ private:
                        int16_t x, int16_t y, int16_t w, int16_t h,
                        bool invert = false, bool mirror_y = false,
                        bool pgm = false);
+  void _transferRows(const uint8_t *first, int16_t stride, int16_t rowBytes,
+                     int16_t rows, bool invert);
   void _setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
   void _PowerOn();
   void _PowerOff();
@@ -0,0 +1,117 @@
+#include "Profile.h"
+
+namespace {
+// the wakeup in progress. it doesn't need to survive deep sleep.
+uint32_t current_[PROFILE_PHASES];
+bool ran_[PROFILE_PHASES];
+
+RTC_DATA_ATTR ProfileRecord history_[PROFILE_HISTORY];
+// history_ is a ring, and newest_ is where the last wakeup went.
+RTC_DATA_ATTR uint8_t newest_;
+RTC_DATA_ATTR uint8_t records_;
+RTC_DATA_ATTR ProfileStats stats_[PROFILE_PHASES];
+
+const char *phaseNames[PROFILE_PHASES] = {
+    "wakeup", "i2c", "dir", "panel", "show", "refresh", "wifi", "fetch", "ntp",
+};
+
+void printMillis(Print &out, uint32_t value) {
+  out.print(value / 1000.0, 1);
+}
+} // namespace
+
+ProfileScope::~ProfileScope() {
+  current_[phase_] += micros() - start_;
+  ran_[phase_] = true;
+}
+
+void profileFinish(uint8_t reason) {
+  // the timer started counting when the app did.
+  current_[PROFILE_WAKEUP] = micros();
+  ran_[PROFILE_WAKEUP]     = true;
+
+  newest_ = (newest_ + 1) % PROFILE_HISTORY;
+  if (records_ < PROFILE_HISTORY) {
+    records_++;
+  }
+  ProfileRecord &record = history_[newest_];
+  record.reason         = reason;
+  for (uint8_t i = 0; i < PROFILE_PHASES; i++) {
+    record.micros[i] = current_[i];
+    if (!ran_[i]) {
+      continue;
+    }
+    ProfileStats &stats = stats_[i];
+    if (stats.count == 0 || current_[i] < stats.min) {
+      stats.min = current_[i];
+    }
+    if (current_[i] > stats.max) {
+      stats.max = current_[i];
+    }
+    stats.total += current_[i];
+    stats.count++;
+    current_[i] = 0;
+    ran_[i]     = false;
+  }
+}
+
+void resetProfile() {
+  newest_  = 0;
+  records_ = 0;
+  for (uint8_t i = 0; i < PROFILE_PHASES; i++) {
+    stats_[i].count = 0;
+    stats_[i].min   = 0;
+    stats_[i].max   = 0;
+    stats_[i].total = 0;
+  }
+}
+
+uint8_t profileRecords() { return records_; }
+
+const ProfileRecord &profileRecord(uint8_t age) {
+  return history_[(newest_ + PROFILE_HISTORY - age) % PROFILE_HISTORY];
+}
+
+const ProfileStats &profileStats(ProfilePhase phase) { return stats_[phase]; }
+
+uint32_t profileAverage(ProfilePhase phase) {
+  if (stats_[phase].count == 0) {
+    return 0;
+  }
+  return stats_[phase].total / stats_[phase].count;
+}
+
+const char *profilePhaseName(ProfilePhase phase) { return phaseNames[phase]; }
+
+void profileDump(Print &out) {
+  out.println("phase\tmin\tavg\tmax\tcount (ms)");
+  for (uint8_t i = 0; i < PROFILE_PHASES; i++) {
+    ProfilePhase phase = (ProfilePhase)i;
+    out.print(phaseNames[i]);
+    out.print("\t");
+    printMillis(out, stats_[i].min);
+    out.print("\t");
+    printMillis(out, profileAverage(phase));
+    out.print("\t");
+    printMillis(out, stats_[i].max);
+    out.print("\t");
+    out.println((unsigned long)stats_[i].count);
+  }
+
+  // the most recent wakeup first.
+  out.print("reason");
+  for (uint8_t i = 0; i < PROFILE_PHASES; i++) {
+    out.print("\t");
+    out.print(phaseNames[i]);
+  }
+  out.println();
+  for (uint8_t age = 0; age < records_; age++) {
+    const ProfileRecord &record = profileRecord(age);
+    out.print(record.reason);
+    for (uint8_t i = 0; i < PROFILE_PHASES; i++) {
+      out.print("\t");
+      printMillis(out, record.micros[i]);
+    }
+    out.println();
+  }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Arduino.h>
+
+// how many of the most recent wakeups are kept.
+const uint8_t PROFILE_HISTORY = 8;
+
+// ProfilePhase names the parts of a wakeup that get timed. A phase that
+// happens more than once in a wakeup, like a screen refresh, adds up.
+typedef enum ProfilePhase {
+  // the whole wakeup, from the app starting until Watchy::sleep().
+  PROFILE_WAKEUP = 0,
+  // Wire.begin() and rtc_.init().
+  PROFILE_I2C = 1,
+  // asking the accelerometer which way the watch is facing.
+  PROFILE_DIRECTION = 2,
+  // waking the panel up and powering it on.
+  PROFILE_PANEL = 3,
+  // an App's show().
+  PROFILE_SHOW = 4,
+  // sending the frame to the panel and refreshing it.
+  PROFILE_REFRESH = 5,
+  // connecting to WiFi.
+  PROFILE_WIFI = 6,
+  // an App's fetchNetwork(), which is mostly HTTP requests.
+  PROFILE_FETCH = 7,
+  // Watchy::syncNTP().
+  PROFILE_NTP    = 8,
+  PROFILE_PHASES = 9,
+} ProfilePhase;
+
+// ProfileRecord is how long each phase took in one wakeup, in microseconds.
+typedef struct ProfileRecord {
+  // the WakeupReason the wakeup started with.
+  uint8_t reason;
+  uint32_t micros[PROFILE_PHASES];
+} ProfileRecord;
+
+// ProfileStats sums up a phase over every wakeup it happened in since the
+// last resetProfile().
+typedef struct ProfileStats {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+} ProfileStats;
+
+// ProfileScope adds the time from its construction to its destruction to
+// phase in the current wakeup.
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfilePhase phase)
+      : phase_(phase), start_(micros()) {}
+  ~ProfileScope();
+
+  ProfileScope(const ProfileScope &)            = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  ProfilePhase phase_;
+  uint32_t start_;
+};
+
+// profileFinish ends the current wakeup, adding it to the history and the
+// stats in RTC memory. Watchy::sleep() calls it.
+void profileFinish(uint8_t reason);
+void resetProfile();
+
+// profileRecords returns how many wakeups are in the history, and
+// profileRecord one of them, where 0 is the most recent.
+uint8_t profileRecords();
+const ProfileRecord &profileRecord(uint8_t age);
+const ProfileStats &profileStats(ProfilePhase phase);
+// profileAverage returns a phase's average in microseconds.
+uint32_t profileAverage(ProfilePhase phase);
+// profilePhaseName returns a short name for phase, for printing.
+const char *profilePhaseName(ProfilePhase phase);
+
+// profileDump prints the stats and the history in milliseconds, such as to
+// Serial.
+void profileDump(Print &out);
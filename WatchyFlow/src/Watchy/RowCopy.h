@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// copyRow copies n bytes of one bitmap row into dst, inverting them if asked,
+// so the display driver can hand the panel a whole row in one SPI write
+// instead of transferring it a byte at a time. Inverting works a 32-bit word
+// at a time; memcpy keeps the loads and stores safe for unaligned rows and
+// compiles down to plain word accesses.
+inline void copyRow(uint8_t *dst, const uint8_t *src, uint16_t n,
+                    bool invert) {
+  if (!invert) {
+    memcpy(dst, src, n);
+    return;
+  }
+  uint16_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    uint32_t word;
+    memcpy(&word, src + i, 4);
+    word = ~word;
+    memcpy(dst + i, &word, 4);
+  }
+  for (; i < n; i++) {
+    dst[i] = ~src[i];
+  }
+}
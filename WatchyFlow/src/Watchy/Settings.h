@@ -17,7 +17,9 @@ typedef enum ButtonConfiguration {
 
 // see settings.h.example for an example and more docs.
 typedef struct WatchySettings {
-  // number of seconds between network fetch attempts
+  // usual number of seconds between network fetch attempts. the watch
+  // fetches sooner when apps ask for it, and waits longer overnight, when
+  // nothing changed or when the battery is low. see FetchReason.
   int networkFetchIntervalSeconds;
 
   // number of failing network fetch tries before giving up until the next
@@ -32,11 +32,53 @@
 #endif
 
 #include "../Layout/Layout.h"
+#include "Profile.h"
 #include "WatchyApp.h"
 
 #define SLEEP_CHECKS_BEFORE_SLEEP 3
+// while the watch is face down, it still wakes up this often to see whether
+// it's been turned back over, unless the accelerometer can wake it up for
+// that. then it only wakes up for triggers, and at least this often.
+#define SLEEPING_MAX_WAKE_MINUTES 15
+#define MOTION_WAKE_MAX_MINUTES   (12 * 60)
+// any-motion is movement of more than this many 1/2048ths of a g (about
+// 83mg) lasting this many 20ms samples.
+#define MOTION_WAKE_THRESHOLD 170
+#define MOTION_WAKE_SAMPLES   5
+#define MAX_TRIGGERS          16
+
+// the time between network fetches stays within these, unless
+// networkFetchIntervalSeconds itself is outside them.
+#define FETCH_MIN_INTERVAL_SECS (10 * 60)
+#define FETCH_MAX_INTERVAL_SECS (8 * 60 * 60)
+// past this many unchanged fetches in a row, the wait stops growing.
+#define FETCH_MAX_UNCHANGED 2
+
+// how long to wait on the remembered access point before scanning for any.
+#define WIFI_DIRECT_TIMEOUT_MS 3000
+// how long after DHCP hands out an address the direct stage keeps using it
+// without asking again. it's counted from the lease, not from the last time
+// the address was used, and kept under half of the shortest leases routers
+// commonly hand out (an hour), which is when DHCP clients renew anyway. past
+// this, the direct stage still skips the scan but asks for a new lease.
+#define WIFI_LEASE_SECS (30 * 60)
 
 namespace {
+// WiFiRecord is what's remembered about the last WiFi connection that worked.
+typedef struct WiFiRecord {
+  // index into settings.wifiNetworks
+  int index;
+  bool valid;
+  uint8_t bssid[6];
+  int32_t channel;
+  // the DHCP lease, zero if there isn't one, and when it was handed out.
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  time_t leased;
+} WiFiRecord;
+
 #ifdef ARDUINO_ESP32S3_DEV
 Watchy32KRTC rtc_;
 #define ACTIVE_LOW 0
@@ -46,25 +88,131 @@ WatchyRTC rtc_;
 #endif
 
 GxEPD2_BW<WatchyDisplay, WatchyDisplay::HEIGHT> display_(WatchyDisplay{});
+HTTPPool http_;
 
 RTC_DATA_ATTR BMA423 sensor_;
 RTC_DATA_ATTR bool usbPluggedIn_;
 RTC_DATA_ATTR time_t lastFetchAttempt_;
 RTC_DATA_ATTR time_t lastSuccessfulNetworkFetch_;
 RTC_DATA_ATTR uint8_t fetchTries_;
+RTC_DATA_ATTR time_t nextFetch_;
+RTC_DATA_ATTR uint8_t nextFetchReasons_;
+RTC_DATA_ATTR uint8_t unchangedFetches_;
 RTC_DATA_ATTR time_t timezoneOffset_;
-RTC_DATA_ATTR int lastSuccessfulWiFiIndex_;
+RTC_DATA_ATTR WiFiRecord wifiRecord_;
+RTC_DATA_ATTR uint16_t wifiMillis_[WIFI_STAGES];
 RTC_DATA_ATTR uint8_t lastMinute_;
 RTC_DATA_ATTR uint32_t totalSteps_;
 RTC_DATA_ATTR bool sleeping_;
 RTC_DATA_ATTR uint8_t sleepChecks_;
+// triggers_ is a min-heap of the times apps asked to be woken up at.
+RTC_DATA_ATTR time_t triggers_[MAX_TRIGGERS];
+RTC_DATA_ATTR uint8_t triggerCount_;
+// motionWake_ is whether the accelerometer interrupt is set to fire on any
+// movement, for waking up from sleeping, instead of on steps, tilts and taps.
+RTC_DATA_ATTR bool motionWake_;
+// wakeupReason_ is what started this wakeup, for the profile.
+WakeupReason wakeupReason_;
+
+void siftDown(uint8_t i) {
+  while (true) {
+    uint8_t smallest = i;
+    uint8_t left     = 2 * i + 1;
+    uint8_t right    = 2 * i + 2;
+    if (left < triggerCount_ && triggers_[left] < triggers_[smallest]) {
+      smallest = left;
+    }
+    if (right < triggerCount_ && triggers_[right] < triggers_[smallest]) {
+      smallest = right;
+    }
+    if (smallest == i) {
+      return;
+    }
+    time_t swap         = triggers_[i];
+    triggers_[i]        = triggers_[smallest];
+    triggers_[smallest] = swap;
+    i                   = smallest;
+  }
+}
+
+void siftUp(uint8_t i) {
+  while (i > 0 && triggers_[(i - 1) / 2] > triggers_[i]) {
+    time_t swap            = triggers_[i];
+    triggers_[i]           = triggers_[(i - 1) / 2];
+    triggers_[(i - 1) / 2] = swap;
+    i                      = (i - 1) / 2;
+  }
+}
+
+// popDueTriggers forgets the triggers that are due by now.
+void popDueTriggers(time_t now) {
+  while (triggerCount_ > 0 && triggers_[0] <= now) {
+    triggers_[0] = triggers_[--triggerCount_];
+    siftDown(0);
+  }
+}
+
+// setMotionWake switches the accelerometer interrupt between waking up from
+// sleeping and its usual events.
+void setMotionWake(bool enable) {
+  if (motionWake_ == enable) {
+    return;
+  }
+  // the driver's feature enable only selects any-motion over no-motion, so
+  // the axes, threshold and duration have to be set too.
+  if (enable &&
+      !sensor_.setAnyMotion(MOTION_WAKE_THRESHOLD, MOTION_WAKE_SAMPLES)) {
+    return;
+  }
+  bool ok = sensor_.enableStepCountInterrupt(!enable) &&
+            sensor_.enableTiltInterrupt(!enable) &&
+            sensor_.enableWakeupInterrupt(!enable) &&
+            sensor_.enableAnyNoMotionInterrupt(enable);
+  motionWake_ = enable && ok;
+}
+
+// minutesUntilWake is how many minutes to sleep for before the next wakeup.
+uint16_t minutesUntilWake() {
+  if (!sleeping_) {
+    return 1;
+  }
+  // motionWake_ is only set once any-motion has been armed, so if that
+  // failed, the watch goes on checking every SLEEPING_MAX_WAKE_MINUTES.
+  uint16_t minutes =
+      motionWake_ ? MOTION_WAKE_MAX_MINUTES : SLEEPING_MAX_WAKE_MINUTES;
+  if (triggerCount_ > 0) {
+    tmElements_t local;
+    rtc_.read(local);
+    time_t now    = makeTime(local) - timezoneOffset_;
+    time_t minute = now - now % 60;
+    time_t until  = (triggers_[0] - minute) / 60;
+    if (until < 1) {
+      until = 1;
+    }
+    if (until < minutes) {
+      minutes = until;
+    }
+  }
+  return minutes;
+}
 } // namespace
 
 void _sensorSetup();
 
 void Watchy::sleep() {
   display_.hibernate();
-  rtc_.clearAlarm(); // resets the alarm flag in the RTC
+  profileFinish(wakeupReason_);
+  if (usbPluggedIn_) {
+    Serial.begin(115200);
+    profileDump(Serial);
+    Serial.flush();
+  }
+  uint16_t wakeMinutes = minutesUntilWake();
+  rtc_.clearAlarm(wakeMinutes); // resets the alarm flag in the RTC
+  uint64_t ext1Mask = BTN_PIN_MASK;
+  if (motionWake_) {
+    ext1Mask |= ACC_INT_MASK;
+  }
 #ifdef ARDUINO_ESP32S3_DEV
   esp_sleep_enable_ext0_wakeup(
       (gpio_num_t)USB_DET_PIN,
@@ -74,7 +222,7 @@ void Watchy::sleep() {
   rtc_gpio_pullup_en((gpio_num_t)USB_DET_PIN);
 
   esp_sleep_enable_ext1_wakeup(
-      BTN_PIN_MASK,
+      ext1Mask,
       ESP_EXT1_WAKEUP_ANY_LOW); // enable deep sleep wake on button press
   rtc_gpio_set_direction((gpio_num_t)UP_BTN_PIN, RTC_GPIO_MODE_INPUT_ONLY);
   rtc_gpio_pullup_en((gpio_num_t)UP_BTN_PIN);
@@ -84,7 +232,8 @@ void Watchy::sleep() {
   struct tm timeinfo;
   getLocalTime(&timeinfo);
   int secToNextMin = 60 - timeinfo.tm_sec;
-  esp_sleep_enable_timer_wakeup(secToNextMin * uS_TO_S_FACTOR);
+  esp_sleep_enable_timer_wakeup((secToNextMin + (wakeMinutes - 1) * 60) *
+                                uS_TO_S_FACTOR);
 #else
   // Set GPIOs 0-39 to input to avoid power leaking out
   const uint64_t ignore =
@@ -97,15 +246,133 @@ void Watchy::sleep() {
   esp_sleep_enable_ext0_wakeup((gpio_num_t)RTC_INT_PIN,
                                0); // enable deep sleep wake on RTC interrupt
   esp_sleep_enable_ext1_wakeup(
-      BTN_PIN_MASK,
+      ext1Mask,
       ESP_EXT1_WAKEUP_ANY_HIGH); // enable deep sleep wake on button press
 #endif
   esp_deep_sleep_start();
 }
 
-bool connectWiFi(WatchySettings settings) {
+uint16_t millisSince(uint32_t start) {
+  uint32_t elapsed = millis() - start;
+  return elapsed > UINT16_MAX ? UINT16_MAX : elapsed;
+}
+
+void rememberWiFi(int index, time_t now) {
+  bool renewed = wifiRecord_.ip == 0 || !wifiRecord_.valid ||
+                 wifiRecord_.index != index;
+  wifiRecord_.index = index;
+  wifiRecord_.valid = true;
+  memcpy(wifiRecord_.bssid, WiFi.BSSID(), sizeof(wifiRecord_.bssid));
+  wifiRecord_.channel = WiFi.channel();
+  if (renewed) {
+    wifiRecord_.ip      = WiFi.localIP();
+    wifiRecord_.gateway = WiFi.gatewayIP();
+    wifiRecord_.subnet  = WiFi.subnetMask();
+    wifiRecord_.dns     = WiFi.dnsIP();
+    wifiRecord_.leased  = now;
+  }
+}
+
+// connectDirect associates with the remembered access point without scanning
+// and, while the lease is fresh, configures the remembered address instead
+// of waiting on DHCP.
+bool connectDirect(WatchySettings settings, time_t now) {
+  // the clock may have been set since, so a lease from the future is stale.
+  if (wifiRecord_.leased > now || now - wifiRecord_.leased > WIFI_LEASE_SECS) {
+    wifiRecord_.ip = 0;
+  }
+  if (wifiRecord_.ip != 0) {
+    WiFi.config(IPAddress(wifiRecord_.ip), IPAddress(wifiRecord_.gateway),
+                IPAddress(wifiRecord_.subnet), IPAddress(wifiRecord_.dns));
+  }
+
+  const WiFiConfig &network = settings.wifiNetworks[wifiRecord_.index];
+  if (WL_CONNECT_FAILED != WiFi.begin(network.SSID.c_str(),
+                                      network.Pass.c_str(),
+                                      wifiRecord_.channel, wifiRecord_.bssid) &&
+      WL_CONNECTED == WiFi.waitForConnectResult(WIFI_DIRECT_TIMEOUT_MS)) {
+    rememberWiFi(wifiRecord_.index, now);
+    return true;
+  }
+
+  // the access point moved, or the address isn't ours anymore. scan and ask
+  // DHCP next time too, in case this wakeup's scan fails.
+  wifiRecord_.valid = false;
+  wifiRecord_.ip    = 0;
+  WiFi.disconnect();
+  WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+  return false;
+}
+
+// scheduleNextFetch picks when the network fetch after the one that ended
+// with result at now should be.
+void scheduleNextFetch(Watchy *watchy, WatchyApp *app,
+                       const WatchySettings &settings, FetchState result,
+                       time_t now) {
+  time_t interval = settings.networkFetchIntervalSeconds;
+  uint8_t reasons = 0;
+
+  if (result == FETCH_TRYAGAIN) {
+    reasons |= FETCH_REASON_FAILED;
+  } else {
+    if (result == FETCH_NOCHANGE) {
+      if (unchangedFetches_ < FETCH_MAX_UNCHANGED) {
+        unchangedFetches_++;
+      }
+    } else {
+      unchangedFetches_ = 0;
+    }
+
+    FetchPace pace = app->fetchPace(watchy);
+    if (pace == FETCH_PACE_SOON) {
+      interval /= 4;
+      reasons |= FETCH_REASON_BUSY;
+    } else {
+      if (pace == FETCH_PACE_IDLE) {
+        interval *= 4;
+        reasons |= FETCH_REASON_IDLE;
+      }
+      if (unchangedFetches_ > 0) {
+        interval <<= unchangedFetches_;
+        reasons |= FETCH_REASON_UNCHANGED;
+      }
+    }
+  }
+
+  int batt = watchy->battPercent();
+  if (batt < 50) {
+    interval *= batt < 20 ? 4 : 2;
+    reasons |= FETCH_REASON_BATTERY;
+  }
+
+  time_t shortest = min((time_t)FETCH_MIN_INTERVAL_SECS,
+                        (time_t)settings.networkFetchIntervalSeconds);
+  time_t longest  = max((time_t)FETCH_MAX_INTERVAL_SECS,
+                        (time_t)settings.networkFetchIntervalSeconds);
+  interval        = constrain(interval, shortest, longest);
+
+  nextFetch_        = now + interval;
+  nextFetchReasons_ = reasons;
+}
+
+bool connectWiFi(WatchySettings settings, time_t now) {
+  ProfileScope scope(PROFILE_WIFI);
+  for (uint8_t stage = 0; stage < WIFI_STAGES; stage++) {
+    wifiMillis_[stage] = 0;
+  }
+
+  uint32_t start = millis();
+  if (wifiRecord_.valid && wifiRecord_.index < settings.wifiNetworkCount) {
+    bool connected                 = connectDirect(settings, now);
+    wifiMillis_[WIFI_STAGE_DIRECT] = millisSince(start);
+    if (connected) {
+      return true;
+    }
+    start = millis();
+  }
+
   for (int i = 0; i < settings.wifiNetworkCount; i++) {
-    int idxToUse = (i + lastSuccessfulWiFiIndex_) % settings.wifiNetworkCount;
+    int idxToUse = (i + wifiRecord_.index) % settings.wifiNetworkCount;
 
     if (WL_CONNECT_FAILED == WiFi.begin(settings.wifiNetworks[idxToUse].SSID,
                                         settings.wifiNetworks[idxToUse].Pass)) {
@@ -118,21 +385,26 @@ bool connectWiFi(WatchySettings settings) {
       continue;
     }
 
-    lastSuccessfulWiFiIndex_ = idxToUse;
+    rememberWiFi(idxToUse, now);
+    wifiMillis_[WIFI_STAGE_SCAN] = millisSince(start);
     return true;
   }
+  wifiMillis_[WIFI_STAGE_SCAN] = millisSince(start);
   return false;
 }
 
 void Watchy::wakeup(WatchyApp *app, WatchySettings settings) {
   esp_sleep_wakeup_cause_t wakeup_reason;
   wakeup_reason = esp_sleep_get_wakeup_cause(); // get wake up reason
+  {
+    ProfileScope scope(PROFILE_I2C);
 #ifdef ARDUINO_ESP32S3_DEV
-  Wire.begin(WATCHY_V3_SDA, WATCHY_V3_SCL); // init i2c
+    Wire.begin(WATCHY_V3_SDA, WATCHY_V3_SCL); // init i2c
 #else
-  Wire.begin(SDA, SCL); // init i2c
+    Wire.begin(SDA, SCL); // init i2c
 #endif
-  rtc_.init();
+    rtc_.init();
+  }
 
   WakeupReason wakeup_reason_enum = WAKEUP_RESET;
 
@@ -146,6 +418,11 @@ void Watchy::wakeup(WatchyApp *app, WatchySettings settings) {
     break;
   case ESP_SLEEP_WAKEUP_EXT1: // button Press
     wakeup_reason_enum = WAKEUP_BUTTON;
+    if (!(esp_sleep_get_ext1_wakeup_status() & (BTN_PIN_MASK))) {
+      // accelerometer interrupt. reading it clears it.
+      wakeup_reason_enum = WAKEUP_MOTION;
+      sensor_.getINT();
+    }
     break;
 #ifdef ARDUINO_ESP32S3_DEV
   case ESP_SLEEP_WAKEUP_EXT0: // USB plug in
@@ -169,14 +446,24 @@ void Watchy::wakeup(WatchyApp *app, WatchySettings settings) {
     lastFetchAttempt_           = 0;
     lastSuccessfulNetworkFetch_ = 0;
     fetchTries_                 = 0;
+    nextFetch_                  = 0;
+    nextFetchReasons_           = 0;
+    unchangedFetches_           = 0;
     timezoneOffset_             = settings.defaultTimezoneOffset;
-    lastSuccessfulWiFiIndex_    = 0;
+    wifiRecord_.index           = 0;
+    wifiRecord_.valid           = false;
+    wifiRecord_.ip              = 0;
     totalSteps_                 = 0;
     sleeping_                   = false;
     sleepChecks_                = 0;
+    triggerCount_               = 0;
+    motionWake_                 = false;
+    resetProfile();
     break;
   }
 
+  wakeupReason_ = wakeup_reason_enum;
+
   tmElements_t currentTime;
   rtc_.read(currentTime);
   Watchy watchy(currentTime, wakeup_reason_enum, settings);
@@ -231,20 +518,28 @@ void Watchy::wakeup(WatchyApp *app, WatchySettings settings) {
 
   if (currentTime.Minute != lastMinute_) {
     lastMinute_ = currentTime.Minute;
+    popDueTriggers(watchy.unixtime());
     app->tick(&watchy);
   }
 
-  uint8_t watchDir = sensor_.getDirection();
+  uint8_t watchDir;
+  {
+    ProfileScope scope(PROFILE_DIRECTION);
+    watchDir = sensor_.getDirection();
+  }
 
   if (sleeping_ && watchDir == DIRECTION_DISP_DOWN) {
     // already sleeping, stay sleeping.
     return;
   }
 
-  display_.epd2.initWatchy();
-  display_.cp437(true);
-  display_.setFullWindow();
-  display_.epd2.asyncPowerOn();
+  {
+    ProfileScope scope(PROFILE_PANEL);
+    display_.epd2.initWatchy();
+    display_.cp437(true);
+    display_.setFullWindow();
+    display_.epd2.asyncPowerOn();
+  }
 
   if (watchDir == DIRECTION_DISP_DOWN) {
     sleeping_ = (++sleepChecks_) >= SLEEP_CHECKS_BEFORE_SLEEP;
@@ -252,10 +547,10 @@ void Watchy::wakeup(WatchyApp *app, WatchySettings settings) {
     sleeping_    = false;
     sleepChecks_ = 0;
   }
+  setMotionWake(sleeping_);
 
   if (sleeping_) {
-    display_.fillScreen(watchy.backgroundColor());
-    watchy.drawNotice("Sleeping...");
+    watchy.drawNotice("Sleeping...", true);
     return;
   }
 
@@ -267,15 +562,13 @@ void Watchy::wakeup(WatchyApp *app, WatchySettings settings) {
     return;
   }
 
-  time_t now       = watchy.unixtime();
-  time_t staleTime = now - settings.networkFetchIntervalSeconds;
+  time_t now = watchy.unixtime();
 
   if (fetchTries_ >= settings.networkFetchTries) {
     // if lastFetchAttempt is in the future, perhaps the timezone
     // just changed, so we don't want to count that.
-    if (lastFetchAttempt_ >= staleTime && lastFetchAttempt_ < now) {
-      // lastFetchAttempt is newer than staleTime but not in the future.
-      // nothing to do.
+    if (now < nextFetch_ && lastFetchAttempt_ < now) {
+      // the next fetch isn't due yet. nothing to do.
       return;
     }
     // okay it's been long enough that we should start over on our try
@@ -286,32 +579,64 @@ void Watchy::wakeup(WatchyApp *app, WatchySettings settings) {
   lastFetchAttempt_ = now;
   fetchTries_++;
 
+  // let the panel refresh the notices while WiFi connects and the fetch
+  // runs, instead of waiting for each refresh to finish first.
+  display_.epd2.asyncRefresh = true;
   watchy.drawNotice("Connecting...");
 
-  if (connectWiFi(settings)) {
+  bool fetched = false;
+  if (connectWiFi(settings, now)) {
     watchy.drawNotice("Loading...   ");
 
-    FetchState fetchResult = app->fetchNetwork(&watchy);
+    FetchState fetchResult;
+    {
+      ProfileScope scope(PROFILE_FETCH);
+      fetchResult = app->fetchNetwork(&watchy);
+    }
+    http_.closeAll();
     if (syncNTP()) {
       rtc_.read(currentTime);
       watchy.reset(currentTime, WAKEUP_NETFETCH);
       now = watchy.unixtime();
-      if (fetchResult == FETCH_OK) {
+      if (fetchResult != FETCH_TRYAGAIN) {
         lastSuccessfulNetworkFetch_ = now;
         fetchTries_                 = settings.networkFetchTries;
+        fetched                     = true;
+        scheduleNextFetch(&watchy, app, settings, fetchResult, now);
       }
     }
 
     WiFi.mode(WIFI_OFF);
     btStop();
   }
+  if (!fetched && fetchTries_ >= settings.networkFetchTries) {
+    scheduleNextFetch(&watchy, app, settings, FETCH_TRYAGAIN,
+                      lastFetchAttempt_);
+  }
 
+  display_.epd2.asyncRefresh = false;
   watchy.updateScreen(app, true);
 }
 
 void Watchy::updateScreen(WatchyApp *app, bool partialRefresh) {
-  app->show(this, &display_);
-  display_.display(partialRefresh);
+  ArenaMark mark(globalArena, ARENA_SCOPE_SHOW);
+  LayoutElement::startFrame();
+  {
+    ProfileScope scope(PROFILE_SHOW);
+    app->show(this, &display_);
+  }
+  {
+    ProfileScope scope(PROFILE_REFRESH);
+    if (!partialRefresh || (layoutDamage.width == WatchyDisplay::WIDTH &&
+                            layoutDamage.height == WatchyDisplay::HEIGHT)) {
+      display_.display(partialRefresh);
+    } else if (layoutDamage.width > 0 && layoutDamage.height > 0) {
+      // only send and refresh the part of the screen that changed. this
+      // assumes the display isn't rotated, which it isn't between frames.
+      display_.displayWindow(layoutDamage.x, layoutDamage.y,
+                             layoutDamage.width, layoutDamage.height);
+    }
+  }
   queuedVibrate();
 }
 
@@ -372,6 +697,38 @@ int Watchy::battPercent() {
   return percent;
 }
 
+void Watchy::addTrigger(time_t when) {
+  // the alarm goes off at the start of the minute, and this minute's tick is
+  // already happening.
+  when -= when % 60;
+  if (when <= unixtime_) {
+    return;
+  }
+  for (uint8_t i = 0; i < triggerCount_; i++) {
+    if (triggers_[i] == when) {
+      return;
+    }
+  }
+  if (triggerCount_ == MAX_TRIGGERS) {
+    // make room by dropping the latest trigger, which is one of the leaves,
+    // if this one is sooner.
+    uint8_t latest = MAX_TRIGGERS / 2;
+    for (uint8_t i = latest + 1; i < MAX_TRIGGERS; i++) {
+      if (triggers_[i] > triggers_[latest]) {
+        latest = i;
+      }
+    }
+    if (triggers_[latest] <= when) {
+      return;
+    }
+    triggers_[latest] = when;
+    siftUp(latest);
+    return;
+  }
+  triggers_[triggerCount_] = when;
+  siftUp(triggerCount_++);
+}
+
 void Watchy::triggerNetworkFetch() {
   lastFetchAttempt_ = 0;
   fetchTries_       = 0;
@@ -408,6 +765,7 @@ tmElements_t Watchy::toLocalTime(time_t unix) {
 }
 
 bool Watchy::syncNTP() {
+  ProfileScope scope(PROFILE_NTP);
   // NTPClient is weird. you ask it for the local time, and then it gives
   // you "epoch time" in local time, which is weird, because epoch time is
   // supposed to always be UTC. c'est la vie. we'll keep this madness
@@ -425,22 +783,46 @@ bool Watchy::syncNTP() {
   return true;
 }
 
+HTTPPool &Watchy::http() { return http_; }
+
+time_t Watchy::nextNetworkFetch() { return nextFetch_; }
+
+uint8_t Watchy::nextNetworkFetchReasons() { return nextFetchReasons_; }
+
+uint16_t Watchy::wifiMillis(WiFiStage stage) { return wifiMillis_[stage]; }
+
 time_t Watchy::lastSuccessfulNetworkFetch() {
   return lastSuccessfulNetworkFetch_;
 }
 
-void Watchy::drawNotice(char *msg) {
+void Watchy::drawNotice(char *msg, bool clearScreen) {
+  ArenaMark mark(globalArena, ARENA_SCOPE_NOTICE);
   LayoutBackground notice(
       LayoutBorder(
           LayoutPad(LayoutText(msg, NULL, foregroundColor()), 3, 3, 3, 3), true,
           true, true, true, foregroundColor()),
       backgroundColor());
 
+  if (clearScreen) {
+    LayoutElement::startFrame();
+    display_.fillScreen(backgroundColor());
+  } else {
+    LayoutElement::startOverlay();
+  }
   uint16_t w, h;
   notice.size(&display_, 0, 0, &w, &h);
-  notice.draw(&display_, display_.width() - w - 3, display_.height() - h - 3, 0,
-              0, &w, &h);
-  display_.display(true);
+  int16_t x = display_.width() - w - 3;
+  int16_t y = display_.height() - h - 3;
+  notice.draw(&display_, x, y, 0, 0, &w, &h);
+  ProfileScope scope(PROFILE_REFRESH);
+  if (clearScreen) {
+    display_.display(true);
+  } else {
+    LayoutElement::overlaid(&display_, x, y, w, h);
+    // the notice is drawn over whatever is already on the screen, so that's
+    // the only part of the screen that needs a refresh.
+    display_.displayWindow(x, y, w, h);
+  }
 }
 
 uint32_t Watchy::stepCounter() { return sensor_.getCounter(); }
@@ -456,6 +838,10 @@ uint32_t Watchy::totalStepCounter() {
 
 uint8_t Watchy::temperature() { return sensor_.readTemperature(); }
 
+uint32_t Watchy::skippedRefreshes() {
+  return display_.epd2.skippedRefreshes();
+}
+
 bool Watchy::accel(AccelData &acc) {
   Accel bmaAcc;
   bool rv = sensor_.getAccel(bmaAcc);
@@ -514,7 +900,12 @@ void _sensorSetup() {
 
   struct bma4_int_pin_config config;
   config.edge_ctrl = BMA4_LEVEL_TRIGGER;
-  config.lvl       = BMA4_ACTIVE_HIGH;
+#ifdef ARDUINO_ESP32S3_DEV
+  // the buttons wake the watch up when they go low, and this has to match.
+  config.lvl = BMA4_ACTIVE_LOW;
+#else
+  config.lvl = BMA4_ACTIVE_HIGH;
+#endif
   config.od        = BMA4_PUSH_PULL;
   config.output_en = BMA4_OUTPUT_ENABLE;
   config.input_en  = BMA4_INPUT_DISABLE;
@@ -532,6 +923,8 @@ void _sensorSetup() {
   sensor_.enableFeature(BMA423_STEP_CNTR, true);
   sensor_.enableFeature(BMA423_TILT, true);
   sensor_.enableFeature(BMA423_WAKEUP, true);
+  // only mapped to the interrupt while sleeping, see setMotionWake.
+  sensor_.enableFeature(BMA423_ANY_MOTION, true);
 
   sensor_.resetStepCounter();
   sensor_.enableStepCountInterrupt();
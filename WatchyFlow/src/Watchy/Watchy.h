@@ -3,6 +3,7 @@
 #include <TimeLib.h>
 #include <GxEPD2_BW.h>
 #include "Display.h"
+#include "../Net/HTTPPool.h"
 
 #ifdef ARDUINO_ESP32S3_DEV
 #define IS_WATCHY_V3
@@ -28,8 +29,35 @@ typedef enum WakeupReason {
   WAKEUP_BUTTON   = 2,
   WAKEUP_USB      = 3,
   WAKEUP_NETFETCH = 4,
+  // the watch was picked up while it was sleeping face down.
+  WAKEUP_MOTION = 5,
 } WakeupReason;
 
+// FetchReason is why the next network fetch is when it is, instead of
+// WatchySettings.networkFetchIntervalSeconds after the last one. Several can
+// apply at once.
+typedef enum FetchReason {
+  // an app asked for it sooner.
+  FETCH_REASON_BUSY = 0x01,
+  // the apps said nobody is likely to be looking.
+  FETCH_REASON_IDLE = 0x02,
+  // the last fetches didn't bring anything new.
+  FETCH_REASON_UNCHANGED = 0x04,
+  // the battery is getting low.
+  FETCH_REASON_BATTERY = 0x08,
+  // the last fetch failed every try.
+  FETCH_REASON_FAILED = 0x10,
+} FetchReason;
+
+typedef enum WiFiStage {
+  // associating straight to the access point that last worked, on its
+  // channel, reusing the last DHCP lease.
+  WIFI_STAGE_DIRECT = 0,
+  // trying each configured network with a full scan and DHCP, if that failed.
+  WIFI_STAGE_SCAN = 1,
+  WIFI_STAGES     = 2,
+} WiFiStage;
+
 typedef enum WatchDirection {
   DIRECTION_TOP_EDGE_UP    = 0,
   DIRECTION_BOTTOM_EDGE_UP = 1,
@@ -94,8 +122,30 @@ public:
   // Why did the watchy wake up? It might not be due to the clock.
   WakeupReason wakeupReason() const { return wakeup_; }
 
+  // addTrigger asks for the watch to wake up and call tick() in the minute
+  // when falls in. The watch wakes up every minute anyway while
+  // it's showing something, but while it's face down it sleeps until the next
+  // trigger instead, so apps that need to do something at a certain time,
+  // like vibrate when an event starts, should ask for it ahead of time.
+  // Triggers are kept in RTC memory, and are forgotten once they're due, so
+  // an app should add the next one it needs each tick().
+  void addTrigger(time_t when);
+
   void triggerNetworkFetch();
   time_t lastSuccessfulNetworkFetch();
+  // nextNetworkFetch is when the next network fetch is due, and
+  // nextNetworkFetchReasons the FetchReason flags for why it's then.
+  time_t nextNetworkFetch();
+  uint8_t nextNetworkFetchReasons();
+
+  // http is where fetchNetwork should get its HTTP clients from, so requests
+  // to the same server share a connection. The connections are closed when
+  // the fetch is over.
+  HTTPPool &http();
+
+  // wifiMillis is how long each stage of the last WiFi connection took, or 0
+  // if it wasn't needed.
+  uint16_t wifiMillis(WiFiStage stage);
 
   // stepCounter and resetStepCounter manage the current counter.
   uint32_t stepCounter();
@@ -105,6 +155,10 @@ public:
 
   uint8_t temperature(); // celsius
 
+  // skippedRefreshes counts the screen updates left out because nothing on
+  // screen changed.
+  uint32_t skippedRefreshes();
+
   bool accel(AccelData &acc);
   WatchDirection direction();
 
@@ -125,7 +179,9 @@ protected:
   void vibrate(uint8_t intervalMs = 100, uint8_t length = 20);
 
   static bool syncNTP();
-  void drawNotice(char *msg);
+  // drawNotice draws msg in a box in the bottom right corner, over what's
+  // already on the screen unless clearScreen is true.
+  void drawNotice(char *msg, bool clearScreen = false);
 
   void updateScreen(WatchyApp *app, bool partialRefresh);
 
@@ -32,7 +32,7 @@ void Watchy32KRTC::config(
   }
 }
 
-void Watchy32KRTC::clearAlarm() {}
+void Watchy32KRTC::clearAlarm(uint16_t minutes) {}
 
 void Watchy32KRTC::read(tmElements_t &tm) {
   time_t now;
@@ -10,7 +10,7 @@ public:
   Watchy32KRTC();
   void init();
   void config(String datetime); // datetime format is YYYY:MM:DD:HH:MM:SS
-  void clearAlarm();
+  void clearAlarm(uint16_t minutes = 1);
   void read(tmElements_t &tm);
   void set(tmElements_t tm);
   uint8_t temperature();
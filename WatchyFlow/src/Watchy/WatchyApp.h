@@ -10,8 +10,42 @@ typedef enum AppState {
 typedef enum FetchState {
   FETCH_OK       = 0,
   FETCH_TRYAGAIN = 1,
+  // the fetch worked, but nothing changed since the last one.
+  FETCH_NOCHANGE = 2,
 } FetchState;
 
+// combineFetchStates is what apps with sub apps should return from
+// fetchNetwork: the fetch needs another try if any of them do, and only
+// nothing changed if nothing changed for all of them.
+inline FetchState combineFetchStates(FetchState a, FetchState b) {
+  if (a == FETCH_TRYAGAIN || b == FETCH_TRYAGAIN) {
+    return FETCH_TRYAGAIN;
+  }
+  if (a == FETCH_OK || b == FETCH_OK) {
+    return FETCH_OK;
+  }
+  return FETCH_NOCHANGE;
+}
+
+// FetchPace is how soon an app would like the next network fetch to be,
+// compared to WatchySettings.networkFetchIntervalSeconds.
+typedef enum FetchPace {
+  // the app doesn't mind.
+  FETCH_PACE_ANY = 0,
+  // nobody is likely to be looking, such as overnight.
+  FETCH_PACE_IDLE = 1,
+  FETCH_PACE_NORMAL = 2,
+  // the app's data is about to matter more than usual, such as before a
+  // busy stretch of meetings.
+  FETCH_PACE_SOON = 3,
+} FetchPace;
+
+// combineFetchPaces is what apps with sub apps should return from fetchPace:
+// whichever of them is in the biggest hurry.
+inline FetchPace combineFetchPaces(FetchPace a, FetchPace b) {
+  return a > b ? a : b;
+}
+
 // WatchyApp is the basic unit of logic for display on a Watchy. WatchyApps
 // can be complex collections of sub apps and sub logic. There are many
 // example Apps in the Apps/ folder.
@@ -27,9 +61,15 @@ public:
   // established (usually once an hour). If the app has network operations it
   // needs to perform from time to time, it should do so in this call. Returning
   // FETCH_TRYAGAIN means that the call failed, and fetchNetwork would like
-  // the Watchy to try again reasonably soon. If the app is active, show() will
-  // be called after this call.
-  virtual FetchState fetchNetwork(Watchy *watchy) { return FETCH_OK; }
+  // the Watchy to try again reasonably soon. FETCH_NOCHANGE means it worked but
+  // nothing was new, which lets the Watchy wait longer before the next one. If
+  // the app is active, show() will be called after this call.
+  virtual FetchState fetchNetwork(Watchy *watchy) { return FETCH_NOCHANGE; }
+
+  // fetchPace is called after each network fetch to help decide when the next
+  // one should be. Like fetchNetwork, it should be passed through to all child
+  // apps.
+  virtual FetchPace fetchPace(Watchy *watchy) { return FETCH_PACE_ANY; }
 
   // tick() is called once a minute and calls to tick should be passed through
   // to all child apps, active or no. Where show() is only called if the app
@@ -1,5 +1,11 @@
 #include "WatchyRTC.h"
 
+namespace {
+// alarmMinutes_ is how far apart the DS3231 alarm was last set for, so it's
+// only set again when that changes.
+RTC_DATA_ATTR uint16_t alarmMinutes_;
+} // namespace
+
 WatchyRTC::WatchyRTC() : rtc_ds(false) {}
 
 void WatchyRTC::init() {
@@ -28,18 +34,29 @@ void WatchyRTC::config(
   }
 }
 
-void WatchyRTC::clearAlarm() {
+void WatchyRTC::clearAlarm(uint16_t minutes) {
+  if (minutes < 1) {
+    minutes = 1;
+  }
   if (rtcType == DS3231) {
     rtc_ds.alarm(DS3232RTC::ALARM_2);
+    if (minutes == 1) {
+      if (alarmMinutes_ > 1) {
+        rtc_ds.setAlarm(DS3232RTC::ALM2_EVERY_MINUTE, 0, 0, 0, 0);
+      }
+    } else {
+      tmElements_t tm;
+      breakTime(rtc_ds.get() + minutes * 60, tm);
+      rtc_ds.setAlarm(DS3232RTC::ALM2_MATCH_HOURS, 0, tm.Minute, tm.Hour, 0);
+    }
+    alarmMinutes_ = minutes;
   } else {
-    int nextAlarmMinute = 0;
     rtc_pcf.clearAlarm(); // resets the alarm flag in the RTC
-    nextAlarmMinute = rtc_pcf.getMinute();
-    nextAlarmMinute =
-        (nextAlarmMinute == 59)
-            ? 0
-            : (nextAlarmMinute + 1); // set alarm to trigger 1 minute from now
-    rtc_pcf.setAlarm(nextAlarmMinute, 99, 99, 99);
+    rtc_pcf.getTime();
+    uint16_t next = rtc_pcf.getHour() * 60 + rtc_pcf.getMinute() + minutes;
+    // set alarm to trigger at the start of the minute that's minutes from
+    // now. the hour only needs matching once that's more than an hour away.
+    rtc_pcf.setAlarm(next % 60, minutes < 60 ? 99 : (next / 60) % 24, 99, 99);
   }
 }
 
@@ -23,7 +23,9 @@ public:
   WatchyRTC();
   void init();
   void config(String datetime); // String datetime format is YYYY:MM:DD:HH:MM:SS
-  void clearAlarm();
+  // clearAlarm resets the alarm flag and sets the alarm to go off again at
+  // the start of the minute that's minutes from now.
+  void clearAlarm(uint16_t minutes = 1);
   void read(tmElements_t &tm);
   void set(tmElements_t tm);
   uint8_t temperature();
@@ -182,6 +182,16 @@ bool BMA423::getAccelConfig(Acfg &cfg) {
   return (BMA4_OK == bma4_get_accel_config(&cfg, &__devFptr));
 }
 
+bool BMA423::setAnyMotion(uint16_t threshold, uint16_t duration,
+                          uint8_t axes) {
+  struct bma423_anymotion_config config;
+  config.threshold    = threshold;
+  config.duration     = duration;
+  config.nomotion_sel = 0;
+  return BMA4_OK == bma423_set_any_motion_config(&config, &__devFptr) &&
+         BMA4_OK == bma423_anymotion_enable_axis(axes, &__devFptr);
+}
+
 bool BMA423::setRemapAxes(struct bma423_axes_remap *remap_data) {
   return (BMA4_OK == bma423_set_remap_axes(remap_data, &__devFptr));
 }
@@ -75,6 +75,11 @@ public:
   bool enableAnyNoMotionInterrupt(bool en = true);
   bool enableActivityInterrupt(bool en = true);
 
+  // setAnyMotion sets how much movement, in 1/2048ths of a g, for how many
+  // 20ms samples, makes for any-motion, and which axes count.
+  bool setAnyMotion(uint16_t threshold, uint16_t duration,
+                    uint8_t axes = BMA423_ALL_AXIS_EN);
+
 private:
   bma4_com_fptr_t __readRegisterFptr;
   bma4_com_fptr_t __writeRegisterFptr;
@@ -7,8 +7,10 @@ This server processes iCalendar files and returns upcoming events.
 
 import argparse
 import datetime
+import hashlib
 import json
 import logging
+import struct
 import threading
 import time
 import urllib.parse
@@ -27,6 +29,33 @@ HOURS_FUTURE = 36
 DAYS_FUTURE = 31
 MINIMUM_MINUTES_PER_COLUMN = 30
 CACHE_STALE_WINDOW_MINUTES = 5
+UPSTREAM_CACHE_TIME_SECS = 10 * 60
+UPSTREAM_STALE_SECS = 60 * 60
+UPSTREAM_TIMEOUT_SECS = 10
+ALARM_TAG = "[WATCHY ALARM]"
+
+# the binary wire format, for format=bin. everything is little endian. the
+# header is the magic bytes "WF", a format version byte, the number of columns
+# as a byte, and the number of events as an unsigned short. version 2 adds a
+# byte with the number of sections. each event is then the start and end as
+# unsigned 32 bit unix timestamps, the column as a signed byte (-1 for day
+# events and alarms), a flags byte, and the summary as a length byte followed
+# by that many ASCII bytes. each section after the events is a type byte, a
+# length byte and that many bytes. the weather section is the temperature and
+# the OpenWeatherMap condition code as signed shorts and the timezone offset in
+# seconds as a signed int. the air quality section is the PM2.5 reading times
+# ten as an unsigned short.
+WIRE_MAGIC = b"WF"
+WIRE_HEADER = struct.Struct("<2sBBH")
+WIRE_HEADER_V2 = struct.Struct("<2sBBHB")
+WIRE_EVENT = struct.Struct("<IIbBB")
+WIRE_FLAG_DAY = 0x01
+WIRE_FLAG_ALARM = 0x02
+WIRE_SECTION = struct.Struct("<BB")
+WIRE_SECTION_WEATHER = 1
+WIRE_WEATHER = struct.Struct("<hhi")
+WIRE_SECTION_AIR_QUALITY = 2
+WIRE_AIR_QUALITY = struct.Struct("<H")
 
 
 class CalendarProcessor:
@@ -226,7 +255,7 @@ class CalendarProcessor:
                 continue
             if (
                 all_events[event_id]["day"]
-                or "[WATCHY ALARM]" in all_events[event_id]["summary"]
+                or ALARM_TAG in all_events[event_id]["summary"]
             ):
                 all_events[event_id]["column"] = -1
                 continue
@@ -252,6 +281,147 @@ class CalendarProcessor:
         return all_events, next_column
 
 
+def encode_sections(extras):
+    sections = []
+    if "weather" in extras:
+        weather = extras["weather"]
+        sections.append(
+            (
+                WIRE_SECTION_WEATHER,
+                WIRE_WEATHER.pack(
+                    max(-0x8000, min(weather["temp"], 0x7FFF)),
+                    max(-0x8000, min(weather["id"], 0x7FFF)),
+                    weather["timezone"],
+                ),
+            )
+        )
+    if "air-quality" in extras:
+        pm25 = round(extras["air-quality"]["pm2.5"] * 10)
+        sections.append(
+            (WIRE_SECTION_AIR_QUALITY, WIRE_AIR_QUALITY.pack(max(0, min(pm25, 0xFFFF))))
+        )
+    return [WIRE_SECTION.pack(kind, len(data)) + data for kind, data in sections]
+
+
+def encode_events(columns, events, extras=None):
+    """Encodes get_events() results in the binary wire format. If extras is
+    given, as from location_extras(), it's encoded in version 2 sections."""
+    events = events[:0xFFFF]
+    columns = min(columns, 0xFF)
+    if extras is None:
+        sections = []
+        parts = [WIRE_HEADER.pack(WIRE_MAGIC, 1, columns, len(events))]
+    else:
+        sections = encode_sections(extras)
+        parts = [
+            WIRE_HEADER_V2.pack(WIRE_MAGIC, 2, columns, len(events), len(sections))
+        ]
+    for event in events:
+        summary = event["summary"]
+        flags = 0
+        if event["day"]:
+            flags |= WIRE_FLAG_DAY
+        elif ALARM_TAG in summary:
+            # the watch would strip the tag anyway, so don't send it.
+            flags |= WIRE_FLAG_ALARM
+            summary = summary.replace(ALARM_TAG, "").strip()
+        summary = summary.encode("ascii", "ignore")[:0xFF]
+        parts.append(
+            WIRE_EVENT.pack(
+                event["start"],
+                event["end"],
+                max(-1, min(event.get("column", -1), 0x7F)),
+                flags,
+                len(summary),
+            )
+        )
+        parts.append(summary)
+    parts.extend(sections)
+    return b"".join(parts)
+
+
+def etag_for(body):
+    """Returns the ETag for a response body."""
+    return '"' + hashlib.sha1(body).hexdigest()[:16] + '"'
+
+
+def etag_matches(if_none_match, etag):
+    """Returns whether an If-None-Match header value matches etag."""
+    if not if_none_match:
+        return False
+    for candidate in if_none_match.split(","):
+        candidate = candidate.strip()
+        if candidate.startswith("W/"):
+            candidate = candidate[2:]
+        if candidate in ("*", etag):
+            return True
+    return False
+
+
+class UpstreamCache:
+    """Caches JSON from upstream APIs, like OpenWeatherMap and PurpleAir, so
+    that every watch shares the same requests and API keys."""
+
+    cache = {}
+
+    @classmethod
+    def fetch(cls, url):
+        cached = cls.cache.get(url, {})
+        ts = cached.get("ts", 0)
+        if ts + UPSTREAM_CACHE_TIME_SECS > time.time():
+            return cached["data"]
+
+        try:
+            resp = requests.get(url, timeout=UPSTREAM_TIMEOUT_SECS)
+            resp.raise_for_status()
+            data = resp.json()
+        except Exception as e:
+            logging.error(f"Error fetching {url}: {e}")
+            # an answer a little out of date is better than none.
+            if ts + UPSTREAM_STALE_SECS > time.time():
+                return cached["data"]
+            return None
+
+        cls.cache[url] = {
+            "ts": time.time(),
+            "data": data,
+        }
+        return data
+
+    @classmethod
+    def precache(cls, cals):
+        for account in cals.values():
+            for location in account.get("locations", {}).values():
+                for key in ("weather-url", "air-quality-url"):
+                    if location.get(key):
+                        cls.fetch(location[key])
+
+
+def location_extras(location):
+    """Returns the weather and air quality for a location in cals.json,
+    leaving out whatever isn't configured or couldn't be fetched."""
+    extras = {}
+    if location.get("weather-url"):
+        data = UpstreamCache.fetch(location["weather-url"])
+        try:
+            extras["weather"] = {
+                "temp": int(data["main"]["temp"]),
+                "id": int(data["weather"][0]["id"]),
+                "timezone": int(data["timezone"]),
+            }
+        except (KeyError, IndexError, TypeError, ValueError):
+            pass
+    if location.get("air-quality-url"):
+        data = UpstreamCache.fetch(location["air-quality-url"])
+        try:
+            extras["air-quality"] = {
+                "pm2.5": float(data["sensor"]["stats"]["pm2.5_30minute"]),
+            }
+        except (KeyError, TypeError, ValueError):
+            pass
+    return extras
+
+
 class CalHandler(BaseHTTPRequestHandler):
 
     def do_GET(self):
@@ -259,6 +429,7 @@ class CalHandler(BaseHTTPRequestHandler):
         query = urllib.parse.parse_qs(url.query)
         if url.path.startswith("/v0/precache/"):
             CalendarProcessor.precache(self.server.cals)
+            UpstreamCache.precache(self.server.cals)
             self.send_response(200)
             self.end_headers()
             return
@@ -299,19 +470,43 @@ class CalHandler(BaseHTTPRequestHandler):
             ical_urls, start, force_cache_miss=force_cache_miss, tz=tz
         )
 
+        # a watch that says where it is gets that location's weather and air
+        # quality too, if they're configured, so it needn't ask for them.
+        extras = None
+        location = (query.get("location") or [None])[-1]
+        if location is not None:
+            extras = location_extras(account.get("locations", {}).get(location, {}))
+
+        if (query.get("format") or ["json"])[-1] == "bin":
+            body = encode_events(columns, all_events, extras)
+            content_type = "application/octet-stream"
+        else:
+            response = {
+                "status": "ok",
+                "columns": columns,
+                "events": all_events,
+            }
+            response.update(extras or {})
+            body = json.dumps(response).encode("utf8")
+            content_type = "application/json"
+
+        # the watch keeps the tag of the calendar it has, so if nothing
+        # changed it doesn't have to download or parse anything.
+        etag = etag_for(body)
+        if etag_matches(self.headers.get("If-None-Match"), etag):
+            self.send_response(304)
+            self.send_header("ETag", etag)
+            self.end_headers()
+            return
+
         self.send_response(200)
-        self.send_header("Content-Type", "application/json")
-        self.send_header("Content-Encoding", "utf-8")
+        self.send_header("Content-Type", content_type)
+        if content_type == "application/json":
+            self.send_header("Content-Encoding", "utf-8")
+        self.send_header("Content-Length", str(len(body)))
+        self.send_header("ETag", etag)
         self.end_headers()
-        self.wfile.write(
-            json.dumps(
-                {
-                    "status": "ok",
-                    "columns": columns,
-                    "events": all_events,
-                }
-            ).encode("utf8")
-        )
+        self.wfile.write(body)
 
 
 def main():
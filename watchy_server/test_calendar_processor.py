@@ -4,13 +4,14 @@ Tests for the calendar processor.
 """
 
 import datetime
+import struct
 import unittest
 from unittest.mock import MagicMock, patch
 
 import icalendar
 from pytz import timezone
 
-from main import CalendarProcessor, TIMEZONE
+from main import CalendarProcessor, TIMEZONE, encode_events, etag_for, etag_matches
 
 
 class TestCalendarProcessor(unittest.TestCase):
@@ -159,5 +160,86 @@ class TestCalendarProcessor(unittest.TestCase):
         mock_events_object.between.assert_called_once()
 
 
+class TestEncodeEvents(unittest.TestCase):
+    """Tests for the binary wire format."""
+
+    def decode(self, data):
+        """Decode the wire format the way the watch does."""
+        magic, version, columns, count = struct.unpack_from("<2sBBH", data)
+        self.assertEqual(magic, b"WF")
+        self.assertEqual(version, 1)
+        offset = 6
+        events = []
+        for _ in range(count):
+            start, end, column, flags, length = struct.unpack_from(
+                "<IIbBB", data, offset
+            )
+            offset += 11
+            summary = data[offset : offset + length].decode("ascii")
+            offset += length
+            events.append((start, end, column, flags, summary))
+        self.assertEqual(offset, len(data))
+        return columns, events
+
+    def test_empty(self):
+        """Test encoding no events."""
+        self.assertEqual(encode_events(1, []), b"WF\x01\x01\x00\x00")
+
+    def test_events(self):
+        """Test encoding timed, day and alarm events."""
+        events = [
+            {"summary": "Holiday", "day": True, "start": 100, "end": 200, "column": -1},
+            {"summary": "Standup", "day": False, "start": 300, "end": 400, "column": 1},
+            {
+                "summary": "[WATCHY ALARM] Leave",
+                "day": False,
+                "start": 500,
+                "end": 600,
+                "column": -1,
+            },
+        ]
+        columns, decoded = self.decode(encode_events(2, events))
+        self.assertEqual(columns, 2)
+        self.assertEqual(
+            decoded,
+            [
+                (100, 200, -1, 0x01, "Holiday"),
+                (300, 400, 1, 0x00, "Standup"),
+                (500, 600, -1, 0x02, "Leave"),
+            ],
+        )
+
+    def test_long_summary(self):
+        """Test that summaries are cut to fit their length byte."""
+        events = [
+            {"summary": "x" * 300, "day": False, "start": 1, "end": 2, "column": 0}
+        ]
+        _, decoded = self.decode(encode_events(1, events))
+        self.assertEqual(decoded[0][4], "x" * 255)
+
+
+class TestETag(unittest.TestCase):
+    """Tests for conditional calendar responses."""
+
+    def test_etag_for(self):
+        """Test that tags are quoted and follow the body."""
+        etag = etag_for(b"body")
+        self.assertEqual(len(etag), 18)
+        self.assertTrue(etag.startswith('"') and etag.endswith('"'))
+        self.assertEqual(etag, etag_for(b"body"))
+        self.assertNotEqual(etag, etag_for(b"other body"))
+
+    def test_etag_matches(self):
+        """Test If-None-Match header matching."""
+        etag = etag_for(b"body")
+        self.assertFalse(etag_matches(None, etag))
+        self.assertFalse(etag_matches("", etag))
+        self.assertTrue(etag_matches(etag, etag))
+        self.assertTrue(etag_matches("W/" + etag, etag))
+        self.assertTrue(etag_matches('"abc", ' + etag, etag))
+        self.assertTrue(etag_matches("*", etag))
+        self.assertFalse(etag_matches(etag_for(b"other body"), etag))
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+Tests for the server's HTTP handling and upstream weather proxying, against a
+fake upstream running locally.
+"""
+
+import json
+import struct
+import threading
+import unittest
+import urllib.error
+import urllib.request
+from http.server import HTTPServer, BaseHTTPRequestHandler
+from unittest.mock import patch
+
+import main
+from main import CalendarProcessor, CalHandler, UpstreamCache, location_extras
+
+WEATHER = {
+    "main": {"temp": 71.6},
+    "weather": [{"id": 800}],
+    "timezone": -14400,
+}
+AIR_QUALITY = {"sensor": {"stats": {"pm2.5_30minute": 4.25}}}
+EVENTS = [
+    {"summary": "Standup", "day": False, "start": 300, "end": 400, "column": 0},
+]
+
+
+class FakeUpstream(BaseHTTPRequestHandler):
+    """Answers like OpenWeatherMap at /weather and PurpleAir at /aqi."""
+
+    def do_GET(self):
+        self.server.hits[self.path] = self.server.hits.get(self.path, 0) + 1
+        body = self.server.responses.get(self.path)
+        if body is None:
+            self.send_response(500)
+            self.end_headers()
+            return
+        body = json.dumps(body).encode("utf8")
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, *args):
+        pass
+
+
+def serve(handler):
+    server = HTTPServer(("127.0.0.1", 0), handler)
+    thread = threading.Thread(target=server.serve_forever)
+    thread.daemon = True
+    thread.start()
+    return server, f"http://127.0.0.1:{server.server_port}"
+
+
+class TestUpstream(unittest.TestCase):
+    """Tests for UpstreamCache and location_extras."""
+
+    def setUp(self):
+        UpstreamCache.cache = {}
+        self.upstream, self.base = serve(FakeUpstream)
+        self.upstream.hits = {}
+        self.upstream.responses = {"/weather": WEATHER, "/aqi": AIR_QUALITY}
+        self.location = {
+            "weather-url": self.base + "/weather",
+            "air-quality-url": self.base + "/aqi",
+        }
+
+    def tearDown(self):
+        self.upstream.shutdown()
+        self.upstream.server_close()
+
+    def test_location_extras(self):
+        """Test that weather and air quality are pulled out of the responses."""
+        self.assertEqual(
+            location_extras(self.location),
+            {
+                "weather": {"temp": 71, "id": 800, "timezone": -14400},
+                "air-quality": {"pm2.5": 4.25},
+            },
+        )
+
+    def test_unconfigured(self):
+        """Test that a location with nothing configured has no extras."""
+        self.assertEqual(location_extras({}), {})
+
+    def test_cached(self):
+        """Test that watches share one upstream request."""
+        location_extras(self.location)
+        location_extras(self.location)
+        self.assertEqual(self.upstream.hits, {"/weather": 1, "/aqi": 1})
+
+    def test_precache(self):
+        """Test that precaching fetches every configured location."""
+        UpstreamCache.precache({"key": {"locations": {"Home": self.location}}})
+        self.assertEqual(self.upstream.hits, {"/weather": 1, "/aqi": 1})
+
+    def test_stale(self):
+        """Test that an upstream failure serves a recent answer, then none."""
+        location_extras(self.location)
+        self.upstream.responses = {}
+        for entry in UpstreamCache.cache.values():
+            entry["ts"] -= main.UPSTREAM_CACHE_TIME_SECS
+        self.assertIn("weather", location_extras(self.location))
+        for entry in UpstreamCache.cache.values():
+            entry["ts"] -= main.UPSTREAM_STALE_SECS
+        self.assertEqual(location_extras(self.location), {})
+
+
+class TestHandler(unittest.TestCase):
+    """Tests for the /v0/account/ endpoint."""
+
+    def setUp(self):
+        UpstreamCache.cache = {}
+        self.upstream, upstream_base = serve(FakeUpstream)
+        self.upstream.hits = {}
+        self.upstream.responses = {"/weather": WEATHER, "/aqi": AIR_QUALITY}
+        self.server, self.base = serve(CalHandler)
+        self.server.cals = {
+            "key": {
+                "ical-urls": [],
+                "locations": {
+                    "Home": {
+                        "weather-url": upstream_base + "/weather",
+                        "air-quality-url": upstream_base + "/aqi",
+                    }
+                },
+            }
+        }
+        patcher = patch.object(
+            CalendarProcessor, "get_events", return_value=(EVENTS, 1)
+        )
+        patcher.start()
+        self.addCleanup(patcher.stop)
+
+    def tearDown(self):
+        for server in (self.server, self.upstream):
+            server.shutdown()
+            server.server_close()
+
+    def get(self, query, headers=None):
+        request = urllib.request.Request(
+            self.base + "/v0/account/key?" + query, headers=headers or {}
+        )
+        try:
+            with urllib.request.urlopen(request) as resp:
+                return resp.status, resp.headers, resp.read()
+        except urllib.error.HTTPError as e:
+            return e.code, e.headers, e.read()
+
+    def test_binary_with_location(self):
+        """Test that a location's weather comes in version 2 sections."""
+        status, _, body = self.get("format=bin&location=Home")
+        self.assertEqual(status, 200)
+        self.assertEqual(struct.unpack_from("<2sBBHB", body), (b"WF", 2, 1, 1, 2))
+        sections = body[7 + 11 + len("Standup") :]
+        self.assertEqual(
+            sections,
+            struct.pack("<BBhhi", 1, 8, 71, 800, -14400)
+            + struct.pack("<BBH", 2, 2, 42),
+        )
+
+    def test_binary_unknown_location(self):
+        """Test that an unconfigured location gets no sections."""
+        status, _, body = self.get("format=bin&location=Work")
+        self.assertEqual(status, 200)
+        self.assertEqual(struct.unpack_from("<2sBBHB", body), (b"WF", 2, 1, 1, 0))
+
+    def test_binary_without_location(self):
+        """Test that watches that don't send a location get version 1."""
+        status, _, body = self.get("format=bin")
+        self.assertEqual(status, 200)
+        self.assertEqual(struct.unpack_from("<2sBBH", body), (b"WF", 1, 1, 1))
+        self.assertEqual(self.upstream.hits, {})
+
+    def test_json_with_location(self):
+        """Test that JSON responses carry the location's weather too."""
+        status, _, body = self.get("location=Home")
+        self.assertEqual(status, 200)
+        response = json.loads(body)
+        self.assertEqual(response["events"], EVENTS)
+        self.assertEqual(response["weather"]["temp"], 71)
+        self.assertEqual(response["air-quality"]["pm2.5"], 4.25)
+
+    def test_not_modified(self):
+        """Test that a matching If-None-Match gets an empty 304."""
+        status, headers, _ = self.get("format=bin&location=Home")
+        self.assertEqual(status, 200)
+        etag = headers["ETag"]
+        status, headers, body = self.get(
+            "format=bin&location=Home", {"If-None-Match": etag}
+        )
+        self.assertEqual(status, 304)
+        self.assertEqual(headers["ETag"], etag)
+        self.assertEqual(body, b"")
+
+
+if __name__ == "__main__":
+    unittest.main()